@@ -0,0 +1,37 @@
+#!/bin/bash
+# Times factorials of N by (product (range 1 N)), whose products are
+# Bignums from 21! on, and (^ 3 100N) by repeated squaring.
+# Usage: bench/bignum.sh [lispy binary]   (./lispy by default)
+# SIZES sets the values of N (default "1000 5000 10000"), RUNS how many
+# times each is run (5 by default). Times are wall clock medians and
+# include loading the prelude.
+
+LISPY=${1:-./lispy}
+RUNS=${RUNS:-5}
+SIZES=${SIZES:-"1000 5000 10000"}
+TMP=$(mktemp -d)
+
+# The prelude is loaded by a path relative to the repository root
+cd "$(dirname "$0")/.."
+
+# Median milliseconds to run lispy with arguments $@
+median_ms() {
+	for ((r = 0; r < RUNS; r++)); do
+		local start=$(date +%s%N)
+		"$LISPY" "$@" > /dev/null
+		local end=$(date +%s%N)
+		echo $(( (end - start) / 1000 ))
+	done | sort -n | awk '{ v[NR] = $1 } END { m = v[int((NR + 1) / 2)]; printf "%d.%03d", m / 1000, m % 1000 }'
+}
+
+printf "%-8s %-12s %-12s %s\n" "n" "n! ms" "3^100n ms" "digits of n!"
+for n in $SIZES; do
+	echo "(def {x} (product (range 1 $n)))" > "$TMP/fact.lspy"
+	echo "(def {x} (^ 3 $((n * 100))))" > "$TMP/exp.lspy"
+	echo "(print (product (range 1 $n)))" > "$TMP/print.lspy"
+	digits=$("$LISPY" libs/prelude.lspy "$TMP/print.lspy" | tr -d ' \n' | wc -c)
+	printf "%-8s %-12s %-12s %s\n" "$n" "$(median_ms libs/prelude.lspy "$TMP/fact.lspy")" \
+		"$(median_ms libs/prelude.lspy "$TMP/exp.lspy")" "$digits"
+done
+
+rm -rf "$TMP"
@@ -0,0 +1,85 @@
+#!/bin/bash
+# Checks on the lispy binary given, printing each failure and exiting
+# non-zero if any fail.
+# Usage: bench/check.sh [lispy binary]   (./make.sh check builds an -O2
+#        binary and runs this on it, taking a few minutes)
+
+LISPY=${1:-./lispy}
+LISPY="$(cd "$(dirname "$LISPY")" && pwd)/$(basename "$LISPY")"
+cd "$(dirname "$0")/.."
+failed=0
+
+# fail <message>
+fail() {
+	echo "FAIL: $1"
+	failed=1
+}
+
+# Leaks: everything made while loading the prelude, or running one of
+# the benchmark workloads, must have been freed by exit
+for f in libs/prelude.lspy bench/suite/*.lspy; do
+	stats=$("$LISPY" --memstats "$f" 2>&1 > /dev/null | grep '^memstats:')
+	if ! echo "$stats" | grep -q 'no leaks'; then
+		fail "$f leaks ($(echo "$stats" | grep -m1 'leaked' || echo 'no memstats'))"
+	fi
+done
+
+TMP=$(mktemp -d)
+
+# Tail calls: each (print ...) line of bench/tail_calls.lspy, run after
+# its definitions on both engines, must finish without an error and use
+# no more memory at 10M iterations than at 1M, by the peak lvals, lenvs
+# and bytes --memstats reports
+grep -v '^(print' bench/tail_calls.lspy > "$TMP/defs.lspy"
+while read -r line; do
+	for engine in vm tree; do
+		peaks=()
+		for n in 1000000 10000000; do
+			{ cat "$TMP/defs.lspy"; echo "${line//10000000/$n}"; } > "$TMP/tail.lspy"
+			out=$("$LISPY" --engine=$engine --memstats "$TMP/tail.lspy" 2> "$TMP/stats")
+			status=$?
+			if [ $status -ne 0 ] || [[ "$out" == Error* ]]; then
+				fail "$line with n = $n on $engine: ${out:-exit status $status}"
+				continue 2
+			fi
+			peaks+=("$(sed -n 's/.*peak \([0-9]*\) lvals, \([0-9]*\) lenvs, \([0-9]*\) bytes.*/\1 \2 \3/p' "$TMP/stats")")
+		done
+		read -r lvals1 lenvs1 bytes1 <<< "${peaks[0]}"
+		read -r lvals10 lenvs10 bytes10 <<< "${peaks[1]}"
+		if [ "$lvals10" -gt "$lvals1" ] || [ "$lenvs10" -gt "$lenvs1" ] || [ "$bytes10" -gt "$bytes1" ]; then
+			fail "$line on $engine grows from a peak of ${peaks[0]} to ${peaks[1]} lvals, lenvs and bytes"
+		fi
+	done
+done < <(grep '^(print' bench/tail_calls.lspy)
+
+# Readers: the fast reader must read each of these as the mpc grammar
+# does, to the same values or to an error at the same row and column.
+# The text of errors differs, so only what comes before it is compared.
+reads=(
+	'(print 1 -2 3.5 -2e3 2.5E-1 9223372036854775808 -9223372036854775809)'
+	'(print +inf.0 -inf.0 +nan.0 {+inf +nan})'
+	'(print "a\"b\n" {x y {z}} (+ 1 2)) ; comment'
+	'1.'
+	'(print 1.)'
+	'(print 1.x)'
+	'(print 12.5.)'
+	'(print 1e.)'
+	'(print 1.2e-.)'
+	'(print -inf.)'
+	'(print -nan.1)'
+	'(1 . 2)'
+	'(print {1 2)'
+	'(print "abc'
+	$'(print 1\n\t2.)'
+)
+for src in "${reads[@]}"; do
+	printf '%s\n' "$src" > "$TMP/read.lspy"
+	fast=$("$LISPY" --reader=fast "$TMP/read.lspy" 2>&1 | sed 's/\(:[0-9]*:[0-9]*: error:\).*/\1/')
+	mpc=$("$LISPY" --reader=mpc "$TMP/read.lspy" 2>&1 | sed 's/\(:[0-9]*:[0-9]*: error:\).*/\1/')
+	if [ "$fast" != "$mpc" ]; then fail "readers differ on $src: $fast, but mpc gives $mpc"; fi
+done
+
+rm -rf "$TMP"
+
+if [ $failed -eq 0 ]; then echo "check: all passed"; fi
+exit $failed
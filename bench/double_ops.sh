@@ -0,0 +1,39 @@
+#!/bin/bash
+# Folds + over a 1M-element list of longs and of doubles, through the
+# prelude's foldl and as a single variadic call.
+# Usage: bench/double_ops.sh [lispy binary]
+# Doubles are held in the lval itself, so both kinds should cost about
+# the same: one lval per call of +, none per element of a variadic call.
+
+LISPY=${1:-./lispy}
+SIZE=1000000
+TMP=$(mktemp -d)
+
+# $1 is printed after each element, making it a Double when ".5"
+gen_list() {
+	echo "(load \"libs/prelude.lspy\")"
+	echo -n "(def {big} {"
+	seq -f "%.0f$1" -s ' ' 1 $SIZE | tr -d '\n'
+	echo "})"
+}
+
+run_ms() {
+	local start=$(date +%s%N)
+	"$LISPY" "$1" > /dev/null
+	local end=$(date +%s%N)
+	echo $(( (end - start) / 1000000 ))
+}
+
+printf "%-10s %-28s %12s\n" "elements" "operation" "ms"
+for kind in long double; do
+	[ $kind = double ] && suffix=.5 || suffix=
+	gen_list "$suffix" > "$TMP/base.lspy"
+	base=$(run_ms "$TMP/base.lspy")
+	for op in "(foldl + 0 big)" "(eval (join {+} big))"; do
+		cp "$TMP/base.lspy" "$TMP/op.lspy"
+		echo "(print $op)" >> "$TMP/op.lspy"
+		printf "%-10s %-28s %12d\n" "$kind" "$op" $(( $(run_ms "$TMP/op.lspy") - base ))
+	done
+done
+
+rm -rf "$TMP"
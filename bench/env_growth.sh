@@ -0,0 +1,47 @@
+#!/bin/bash
+# Measures symbol lookup cost as the global environment grows.
+# Usage: bench/env_growth.sh [lispy binary]
+# For each environment size N a script defining N globals is timed
+# running the same shallow recursive loop with and without LOOKUPS
+# references to those globals; the difference is the lookup cost.
+# The loop is kept shallow so the walk up the caller chain stays short.
+
+LISPY=${1:-./lispy}
+LOOKUPS=1000000
+DEPTH=5
+TMP=$(mktemp -d)
+
+gen_defs() {
+	for ((i = 0; i < $1; i++)); do echo "(def {v$i} $i)"; done
+}
+
+gen_loop() {
+	# Recurse DEPTH times, referencing 10 symbols spread over the whole
+	# environment per step (or 10 constants for the baseline), REPEAT times
+	local n=$1 refs=""
+	for ((i = 0; i < 10; i++)); do
+		if [ "$2" = "full" ]; then refs="$refs v$((i * 7919 % n))"; else refs="$refs 0"; fi
+	done
+	echo "(def {spin} (\\ {k} {if (== k 0) {0} {spin (- k 1 (* 0 (+$refs)))}}))"
+	for ((i = 0; i < LOOKUPS / 10 / DEPTH; i++)); do echo "(spin $DEPTH)"; done
+}
+
+run_ms() {
+	local start=$(date +%s%N)
+	"$LISPY" "$1" > /dev/null
+	local end=$(date +%s%N)
+	echo $(( (end - start) / 1000000 ))
+}
+
+printf "%10s %12s %12s %14s\n" "bindings" "base (ms)" "total (ms)" "ns/lookup"
+for n in 100 1000 10000 20000; do
+	gen_defs $n > "$TMP/base.lspy"
+	cp "$TMP/base.lspy" "$TMP/full.lspy"
+	gen_loop $n base >> "$TMP/base.lspy"
+	gen_loop $n full >> "$TMP/full.lspy"
+	base=$(run_ms "$TMP/base.lspy")
+	full=$(run_ms "$TMP/full.lspy")
+	printf "%10d %12d %12d %14d\n" $n $base $full $(( (full - base) * 1000000 / LOOKUPS ))
+done
+
+rm -rf "$TMP"
@@ -0,0 +1,36 @@
+#!/bin/bash
+# Folds + over a 1M-element list, through the prelude's foldl and as a
+# single variadic call.
+# Usage: bench/fold_add.sh [lispy binary]
+# The first spends its time calling + with two arguments, the second
+# in the accumulation loop of one call over every element.
+
+LISPY=${1:-./lispy}
+SIZE=1000000
+TMP=$(mktemp -d)
+
+gen_list() {
+	echo "(load \"libs/prelude.lspy\")"
+	echo -n "(def {big} {"
+	seq -s ' ' 1 $SIZE | tr -d '\n'
+	echo "})"
+}
+
+run_ms() {
+	local start=$(date +%s%N)
+	"$LISPY" "$1" > /dev/null
+	local end=$(date +%s%N)
+	echo $(( (end - start) / 1000000 ))
+}
+
+gen_list > "$TMP/base.lspy"
+base=$(run_ms "$TMP/base.lspy")
+
+printf "%-28s %12s\n" "operation" "ms"
+for op in "(foldl + 0 big)" "(eval (join {+} big))"; do
+	cp "$TMP/base.lspy" "$TMP/op.lspy"
+	echo "(print $op)" >> "$TMP/op.lspy"
+	printf "%-28s %12d\n" "$op" $(( $(run_ms "$TMP/op.lspy") - base ))
+done
+
+rm -rf "$TMP"
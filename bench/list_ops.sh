@@ -0,0 +1,36 @@
+#!/bin/bash
+# Times join, head, and tail on a 100k-element list.
+# Usage: bench/list_ops.sh [lispy binary]
+# Each operation is run REPS times against a globally bound list, so
+# it sees a shared list as it would in real code.
+
+LISPY=${1:-./lispy}
+SIZE=100000
+REPS=2000
+TMP=$(mktemp -d)
+
+gen_list() {
+	echo -n "(def {big} {"
+	seq -s ' ' 0 $((SIZE - 1)) | tr -d '\n'
+	echo "})"
+}
+
+run_ms() {
+	local start=$(date +%s%N)
+	"$LISPY" "$1" > /dev/null
+	local end=$(date +%s%N)
+	echo $(( (end - start) / 1000000 ))
+}
+
+gen_list > "$TMP/base.lspy"
+base=$(run_ms "$TMP/base.lspy")
+
+printf "%-28s %12s\n" "operation (x$REPS)" "ms"
+for op in "(head big)" "(tail big)" "(join big big)" "(def {w} (tail w))"; do
+	cp "$TMP/base.lspy" "$TMP/op.lspy"
+	echo "(def {w} big)" >> "$TMP/op.lspy"
+	for ((i = 0; i < REPS; i++)); do echo "$op"; done >> "$TMP/op.lspy"
+	printf "%-28s %12d\n" "$op" $(( $(run_ms "$TMP/op.lspy") - base ))
+done
+
+rm -rf "$TMP"
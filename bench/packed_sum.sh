@@ -0,0 +1,53 @@
+#!/bin/bash
+# Sums a 10M-element list through the prelude's sum, a foldl of +, and
+# the same numbers packed by ivec and dvec through vsum, and times
+# element-wise v+ and vdot on them.
+# Usage: bench/packed_sum.sh [lispy binary]
+# SIZE sets the number of elements. Build with -march=native for the
+# AVX kernels, SSE2 being the default on x86-64 (see source/lpack.c).
+# Times exclude reading the list, and packing it for the rows after
+# ivec and dvec, which repeat the operation 100 times.
+
+LISPY=${1:-./lispy}
+SIZE=${SIZE:-10000000}
+TMP=$(mktemp -d)
+
+# Elements below 1000 are preallocated Numbers, so the list costs only
+# its cells and the comparison is of the summing alone
+gen_list() {
+	echo "(load \"libs/prelude.lspy\")"
+	echo -n "(def {big} {"
+	awk -v n=$SIZE 'BEGIN { for (i = 0; i < n; i++) printf "%d ", i % 1000 }'
+	echo "})"
+}
+
+run_ms() {
+	local start=$(date +%s%N)
+	"$LISPY" "$1" > /dev/null
+	local end=$(date +%s%N)
+	echo $(( (end - start) / 1000000 ))
+}
+
+gen_list > "$TMP/base.lspy"
+base=$(run_ms "$TMP/base.lspy")
+
+# Milliseconds of $1 over the time of the base file with $2 appended
+op_ms() {
+	cp "$TMP/base.lspy" "$TMP/op.lspy"
+	echo "$2" >> "$TMP/op.lspy"
+	local before=$(run_ms "$TMP/op.lspy")
+	echo "(print $1)" >> "$TMP/op.lspy"
+	echo $(( $(run_ms "$TMP/op.lspy") - before ))
+}
+
+printf "%-44s %12s\n" "operation ($SIZE elements)" "ms"
+printf "%-44s %12d\n" "(sum big)" $(op_ms "(sum big)" "")
+for kind in ivec dvec; do
+	vv="(def {v} ($kind big))"
+	printf "%-44s %12d\n" "($kind big)" $(op_ms "(vlen ($kind big))" "")
+	printf "%-44s %12d\n" "(vsum v) x100, v = ($kind big)" $(op_ms "(len (map (\\ {i} {vsum v}) (range 1 100)))" "$vv")
+	printf "%-44s %12d\n" "(vdot v v) x100" $(op_ms "(len (map (\\ {i} {vdot v v}) (range 1 100)))" "$vv")
+	printf "%-44s %12d\n" "(v+ v v) x100" $(op_ms "(len (map (\\ {i} {vlen (v+ v v)}) (range 1 100)))" "$vv")
+done
+
+rm -rf "$TMP"
@@ -0,0 +1,41 @@
+#!/bin/bash
+# Times reading large generated source files with each reader.
+# Usage: bench/parse_large.sh [lispy binary]   (./lispy by default)
+# SIZES_KB sets the sizes of the files in KB (51200, 50MB, by default) and
+# READERS the readers timed ("fast mpc" by default). The mpc grammar takes
+# minutes and several GB at 50MB. bench/parse_scaling.sh runs this over
+# sizes from 1KB to 100MB, so time per KB shows how reading scales.
+# The files hold definitions of quoted data, so evaluating them costs
+# little beside the reading; times are wall clock, peak RSS from --memstats.
+
+LISPY=${1:-./lispy}
+SIZES_KB=${SIZES_KB:-51200}
+READERS=${READERS:-"fast mpc"}
+TMP=$(mktemp -d)
+
+# Lines of about 90 bytes up to $1 KB
+gen_large() {
+	awk -v bytes=$(($1 * 1024)) 'BEGIN {
+		for (i = 0; n < bytes; i++) {
+			line = sprintf("(def {d} {(%d \"s%d\" {a b c} (+ 1 2) sym-%d) {nested {deeper {deepest %d}}}}) ; %d", i, i, i, i, i)
+			print line
+			n += length(line) + 1
+		}
+	}'
+}
+
+printf "%-8s %12s %10s %12s %14s\n" "reader" "bytes" "ms" "us per KB" "peak rss KB"
+for kb in $SIZES_KB; do
+	gen_large $kb > "$TMP/large.lspy"
+	bytes=$(wc -c < "$TMP/large.lspy")
+
+	for reader in $READERS; do
+		start=$(date +%s%N)
+		rss=$("$LISPY" --reader=$reader --memstats "$TMP/large.lspy" 2>&1 > /dev/null | sed -n 's/.*peak rss \([0-9]*\) KB.*/\1/p')
+		end=$(date +%s%N)
+		us=$(( (end - start) / 1000 ))
+		printf "%-8s %12d %10d %12d %14s\n" "$reader" "$bytes" $((us / 1000)) $((us * 1024 / bytes)) "${rss:-?}"
+	done
+done
+
+rm -rf "$TMP"
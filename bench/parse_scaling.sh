@@ -0,0 +1,8 @@
+#!/bin/bash
+# Times reading generated source files from 1KB to 100MB, one size per
+# row, with a steady time per KB showing reading scales linearly.
+# Usage: bench/parse_scaling.sh [lispy binary]   (./lispy by default)
+# READERS and SIZES_KB are passed on to bench/parse_large.sh.
+
+export SIZES_KB=${SIZES_KB:-"1 10 100 1024 10240 102400"}
+exec "$(dirname "$0")/parse_large.sh" "$@"
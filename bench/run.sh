@@ -0,0 +1,74 @@
+#!/bin/bash
+# Runs the workloads in bench/suite, plus parsing a large generated
+# file, on each lispy binary given and prints the results as JSON.
+# Usage: bench/run.sh [lispy binary...]   (./make.sh bench builds a debug
+#        and an -O2 binary and runs this on both)
+# RUNS sets how many times each workload is run (10 by default) and
+# PARSE_LINES the size of the parse file (5000 lines, about 450KB).
+# Times are wall clock; allocations and peak RSS come from --memstats.
+
+RUNS=${RUNS:-10}
+PARSE_LINES=${PARSE_LINES:-5000}
+TMP=$(mktemp -d)
+
+if [ $# -eq 0 ]; then set -- ./lispy; fi
+
+# Workloads load the prelude by a path relative to the repository root,
+# so binaries are found by absolute path before moving there
+BINS=()
+for bin in "$@"; do BINS+=("$(cd "$(dirname "$bin")" && pwd)/$(basename "$bin")"); done
+cd "$(dirname "$0")/.."
+
+# Parse-only: definitions of quoted data, so evaluating them costs little
+gen_parse() {
+	for ((i = 0; i < PARSE_LINES; i++)); do
+		echo "(def {d} {($i \"s$i\" {a b c} (+ 1 2) sym-$i) {nested {deeper {deepest $i}}}}) ; $i"
+	done
+}
+gen_parse > "$TMP/parse.lspy"
+
+# Value of the percentile $1 of numbers on stdin
+percentile() {
+	sort -n | awk -v p="$1" '{ v[NR] = $1 } END { i = int((NR - 1) * p / 100 + 0.5) + 1; print v[i] }'
+}
+
+# Print the JSON object for running binary $1 on workload file $2,
+# with the binary reported by its name
+run_workload() {
+	local times=""
+	local stats=""
+	for ((r = 0; r < RUNS; r++)); do
+		local start=$(date +%s%N)
+		stats=$("$1" --memstats "$2" 2>&1 > /dev/null | grep '^memstats:')
+		local end=$(date +%s%N)
+		times="$times$(( (end - start) / 1000 ))"$'\n'
+	done
+
+	local median=$(echo -n "$times" | percentile 50)
+	local p95=$(echo -n "$times" | percentile 95)
+	local lvals=$(echo "$stats" | sed -n 's/.* \([0-9]*\) lvals and.*/\1/p')
+	local lenvs=$(echo "$stats" | sed -n 's/.* \([0-9]*\) lenvs allocated.*/\1/p')
+	local rss=$(echo "$stats" | sed -n 's/.*peak rss \([0-9]*\) KB.*/\1/p')
+
+	printf '    {"binary": "%s", "workload": "%s", "runs": %d, "median_ms": %d.%03d, "p95_ms": %d.%03d, ' \
+		"$(basename "$1")" "$(basename "$2" .lspy)" "$RUNS" $((median / 1000)) $((median % 1000)) $((p95 / 1000)) $((p95 % 1000))
+	printf '"lval_allocs": %s, "lenv_allocs": %s, "peak_rss_kb": %s}' "${lvals:-null}" "${lenvs:-null}" "${rss:-null}"
+}
+
+echo "{"
+echo "  \"commit\": \"$(git rev-parse --short HEAD 2>/dev/null)\","
+echo "  \"date\": \"$(date -u +%Y-%m-%dT%H:%M:%SZ)\","
+echo "  \"results\": ["
+first=1
+for bin in "${BINS[@]}"; do
+	for w in bench/suite/*.lspy "$TMP/parse.lspy"; do
+		if [ $first -eq 0 ]; then echo ","; fi
+		first=0
+		run_workload "$bin" "$w"
+	done
+done
+echo
+echo "  ]"
+echo "}"
+
+rm -rf "$TMP"
@@ -0,0 +1,55 @@
+#!/bin/bash
+# Times a round trip of a list of 1M elements through a file, as text
+# printed by print and loaded again, and as binary by serialize and
+# deserialize. Usage: bench/serialize.sh [lispy binary]   (./lispy by default)
+# COUNT sets the number of elements and READERS the readers loading the
+# text ("fast" by default, "fast mpc" to time the mpc grammar as well).
+# Times are wall clock, less the time to start and build the list.
+
+LISPY=${1:-./lispy}
+COUNT=${COUNT:-1000000}
+READERS=${READERS:-fast}
+TMP=$(mktemp -d)
+
+# Numbers, strings, symbols and small lists in turn
+awk -v n=$COUNT 'BEGIN {
+	printf "(def {big} {"
+	for (i = 0; i < n; i++) {
+		if (i % 4 == 0) { printf " %d", i * 7919 - 500000 }
+		if (i % 4 == 1) { printf " \"item %d\"", i }
+		if (i % 4 == 2) { printf " sym%d", i % 1000 }
+		if (i % 4 == 3) { printf " {%d {a b} \"c\"}", i }
+	}
+	print "})"
+}' > "$TMP/big.lspy"
+
+echo '(print big)' > "$TMP/print.lspy"
+echo "(serialize \"$TMP/big.bin\" big)" > "$TMP/serialize.lspy"
+echo "(def {copy} (deserialize \"$TMP/big.bin\"))" > "$TMP/deserialize.lspy"
+
+# Milliseconds taken by running lispy with arguments $@
+ms() {
+	local start=$(date +%s%N)
+	"$LISPY" "$@" > /dev/null
+	local end=$(date +%s%N)
+	echo $(( (end - start) / 1000000 ))
+}
+
+build=$(ms "$TMP/big.lspy")
+
+start=$(date +%s%N)
+{ printf "(def {copy} "; "$LISPY" "$TMP/big.lspy" "$TMP/print.lspy"; echo ")"; } > "$TMP/copy.lspy"
+end=$(date +%s%N)
+print=$(( (end - start) / 1000000 - build ))
+
+serialize=$(( $(ms "$TMP/big.lspy" "$TMP/serialize.lspy") - build ))
+deserialize=$(ms "$TMP/deserialize.lspy")
+
+echo "list of $COUNT elements, built in $build ms"
+echo "text:   $(wc -c < "$TMP/copy.lspy") bytes, print $print ms"
+for reader in $READERS; do
+	echo "        load with the $reader reader $(ms --reader=$reader "$TMP/copy.lspy") ms"
+done
+echo "binary: $(wc -c < "$TMP/big.bin") bytes, serialize $serialize ms, deserialize $deserialize ms"
+
+rm -rf "$TMP"
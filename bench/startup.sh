@@ -0,0 +1,45 @@
+#!/bin/bash
+# Times starting lispy with the prelude and a generated library of 5000
+# definitions, loading them from source and from an image of them.
+# Usage: bench/startup.sh [lispy binary]   (./lispy by default)
+# RUNS sets how many times each is run (10 by default) and DEFS the
+# number of definitions in the library. Times are wall clock medians.
+
+LISPY=${1:-./lispy}
+RUNS=${RUNS:-10}
+DEFS=${DEFS:-5000}
+TMP=$(mktemp -d)
+
+# The prelude is loaded by a path relative to the repository root
+cd "$(dirname "$0")/.."
+
+# Alternately functions and data, each using what came before
+for ((i = 0; i < DEFS; i++)); do
+	if ((i % 2 == 0)); then
+		echo "(fun {f$i x y} {if (> x y) {+ x $i} {foldl + y {x $i 3}}})"
+	else
+		echo "(def {d$i} {$i \"item $i\" {k$i (f$((i - 1)) $i 1)}})"
+	fi
+done > "$TMP/library.lspy"
+echo "(print (f0 1 2) (d$((DEFS - 1))))" > "$TMP/main.lspy"
+
+"$LISPY" --dump-image="$TMP/library.img" libs/prelude.lspy "$TMP/library.lspy" > /dev/null
+
+# Median milliseconds to run lispy with arguments $@
+median_ms() {
+	for ((r = 0; r < RUNS; r++)); do
+		local start=$(date +%s%N)
+		"$LISPY" "$@" > /dev/null
+		local end=$(date +%s%N)
+		echo $(( (end - start) / 1000 ))
+	done | sort -n | awk '{ v[NR] = $1 } END { m = v[int((NR + 1) / 2)]; printf "%d.%03d", m / 1000, m % 1000 }'
+}
+
+echo "library: $DEFS definitions, $(wc -c < "$TMP/library.lspy") bytes; image: $(wc -c < "$TMP/library.img") bytes"
+echo "source: $(median_ms libs/prelude.lspy "$TMP/library.lspy" "$TMP/main.lspy") ms"
+echo "image:  $(median_ms --image="$TMP/library.img" "$TMP/main.lspy") ms"
+if [ "$("$LISPY" libs/prelude.lspy "$TMP/library.lspy" "$TMP/main.lspy")" != "$("$LISPY" --image="$TMP/library.img" "$TMP/main.lspy")" ]; then
+	echo "outputs differ"
+fi
+
+rm -rf "$TMP"
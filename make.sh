@@ -1,4 +1,36 @@
 #!/bin/bash
-cd source;
-gcc -std=c99 -g -Wall main.c mpc.c parse.c lisputils.c builtin.c lvalue.c lenviron.c -ledit -lm -o ../lispy;
-cd ..;
+# Usage: ./make.sh [bench | check]
+#   bench  build a debug and an -O2 interpreter in bench/build and run bench/run.sh
+#          on both, printing median/p95 times, allocations and peak RSS as JSON
+#   check  build an -O2 interpreter in bench/build and run bench/check.sh on it,
+#          failing if the prelude or a benchmark workload leaks, or a tail call
+#          loop grows in memory between 1M and 10M iterations
+# The interpreter takes --engine=vm|tree to choose how lambda bodies run (vm by default),
+# --profile[=FILE] to report time per function on exit, with FILE a flamegraph.pl input,
+# --memstats to print allocation counts and leaks on exit, and --reader=fast|mpc to choose
+# how source is read (fast by default, mpc being the original parser combinator grammar).
+# --dump-image=FILE writes the global environment to FILE after loading the files given,
+# and --image=FILE starts from it, skipping the prelude and libraries it was made from
+FILES="main.c mpc.c parse.c lisputils.c builtin.c lvalue.c lenviron.c lsymbol.c lalloc.c lcompile.c lvm.c lprof.c lread.c lserial.c limage.c lbignum.c lpack.c lpackbuiltin.c"
+
+# build <flags> <output, relative to source>
+build() {
+	(cd source && gcc -std=c11 -Wall $1 $FILES -ledit -lm -o $2)
+}
+
+if [ "$1" == "bench" ]; then
+	mkdir -p bench/build
+	build "-g" ../bench/build/lispy-debug || exit 1
+	build "-g -O2" ../bench/build/lispy-O2 || exit 1
+	bench/run.sh bench/build/lispy-debug bench/build/lispy-O2
+	exit
+fi
+
+if [ "$1" == "check" ]; then
+	mkdir -p bench/build
+	build "-g -O2" ../bench/build/lispy-check || exit 1
+	bench/check.sh bench/build/lispy-check
+	exit
+fi
+
+build "-g" ../lispy
@@ -1,7 +1,7 @@
 
 /*========================================= Includes =========================================*/
 // Standard Includes
-#include <string.h>
+#include <limits.h>
 
 // Library Includes
 #include "mpc.h"
@@ -10,6 +10,10 @@
 #include "lisputils.h"
 #include "lenviron.h"
 #include "lvalue.h"
+#include "lalloc.h"
+#include "lvm.h"
+#include "lread.h"
+#include "lserial.h"
 #include "parse.h"
 
 // Header Include
@@ -17,16 +21,13 @@
 
 /*================================== Builtin Infrastructure ==================================*/
 
-lval* builtin(lenv* e, lval* a, char* func) {
-	if (strcmp("list", func) == 0) { return builtin_list(e, a); }
-	if (strcmp("head", func) == 0) { return builtin_head(e, a); }
-	if (strcmp("tail", func) == 0) { return builtin_tail(e, a); }
-	if (strcmp("join", func) == 0) { return builtin_join(e, a); }
-	if (strcmp("eval", func) == 0) { return builtin_eval(e, a); }
-	if (strstr("+-/*", func)) { return builtin_op(e, a, func); }
-	lval_del(a);
-	return lval_err("Unknown Function '%s'!", func);
-}
+/* Operators of the builtins sharing an implementation. Each builtin  */
+/* passes a constant, and the shared functions are inlined, so every */
+/* operator gets its own copy with the choice of operation resolved. */
+enum { OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_GT, OP_LT, OP_GE, OP_LE, OP_EQ, OP_NE, OP_DEF, OP_PUT };
+
+/* Operator names, for error messages */
+static char* op_names[] = { "+", "-", "*", "/", ">", "<", ">=", "<=", "==", "!=", "def", "=" };
 
 lval* builtin_lambda(lenv* e, lval* a) {
 	/*Check Two Arguments, each of which are Q-expr */
@@ -51,12 +52,16 @@ lval* builtin_lambda(lenv* e, lval* a) {
 	lval* body = lval_pop(a, 0);
 	lval_del(a);
 
-	return lval_lambda(formals, body);
+	/* Resolve the body's symbols now, while creating the lambda */
+	lval* f = lval_lambda(formals, body);
+	lvm_prepare(f);
+	return f;
 }
 
 /*===================================== Lambda Expressions =====================================*/
 
-lval* builtin_var(lenv* e, lval* a, char* func) {
+static inline lval* builtin_var(lenv* e, lval* a, int op) {
+	char* func = op_names[op];
 	LASSERT_TYPE(func, a, 0, LVAL_QEXPR);
 
 	/* First argument is symbol list */
@@ -77,10 +82,9 @@ lval* builtin_var(lenv* e, lval* a, char* func) {
 		/* If 'def' define in globally. 
 		   If 'put' define in local scope */
 
-		if (strcmp(func, "def") == 0) {
+		if (op == OP_DEF) {
 			lenv_def(e, syms->cell[i], a->cell[i+1]);
-		}
-		if (strcmp(func, "=") == 0) {
+		} else {
 			lenv_put(e, syms->cell[i], a->cell[i+1]);
 		}
 	}
@@ -90,101 +94,277 @@ lval* builtin_var(lenv* e, lval* a, char* func) {
 }
 
 lval* builtin_put(lenv* e, lval* a) {
-	return builtin_var(e, a, "=");
+	return builtin_var(e, a, OP_PUT);
 }
 
 lval* builtin_def(lenv* e, lval* a) {
-	return builtin_var(e, a, "def");
+	return builtin_var(e, a, OP_DEF);
 }
 
 /*=================================== Arithmetic Operations ===================================*/
 
 
-lval* builtin_op(lenv* e, lval* a, char* op){
+/* Numbers are longs until a result will not fit, then Bignums. A Bignum */
+/* is never within the range of a long, see lval_bignum. Once a Double  */
+/* is met the rest of an operation is done in doubles.                  */
+int builtin_is_num(lval* v) {
+	return v->type == LVAL_NUM || v->type == LVAL_BIGNUM || v->type == LVAL_DBL;
+}
+
+double builtin_dbl(lval* v) {
+	switch (v->type) {
+		case LVAL_NUM: return (double)v->num;
+		case LVAL_BIGNUM: return lbig_to_double(&v->big);
+		default: return v->dbl;
+	}
+}
+
+/* Finish the operation in doubles from the argument at 'i' on */
+static lval* builtin_op_dbl(lval* a, int op, double x, int i) {
+	if (op == OP_SUB && a->count == 1) { x = -x; }
+
+	for (; i < a->count; i++) {
+		double y = builtin_dbl(a->cell[i]);
+		switch (op) {
+			case OP_ADD: x += y; break;
+			case OP_SUB: x -= y; break;
+			case OP_MUL: x *= y; break;
+			case OP_DIV:
+				if (y == 0) {
+					lval_del(a);
+					return lval_err("Division by Zero!");
+				}
+				x /= y;
+			break;
+		}
+	}
+
+	lval_del(a);
+	return lval_dbl(x);
+}
+
+/* 'v' as a Bignum view, in 'room' if it is a plain number */
+static void builtin_big(lval* v, lbig* b, uint32_t room[LBIG_LONG_DIGITS]) {
+	if (v->type == LVAL_NUM) { lbig_view(b, v->num, room); return; }
+	*b = v->big;
+	b->cap = 0;
+}
+
+/* Finish the operation in Bignums once 'x' has met a Bignum or a result */
+/* that overflows, from the argument at 'i' on                           */
+static lval* builtin_op_big(lval* a, int op, lbig* x, int i) {
+	lbig acc;
+	lbig_copy(&acc, x);
+	if (op == OP_SUB && a->count == 1) { acc.sign = acc.len > 0 ? -acc.sign : 1; }
+
+	for (; i < a->count; i++) {
+		if (a->cell[i]->type == LVAL_DBL) {
+			double d = lbig_to_double(&acc);
+			lbig_free(&acc);
+			return builtin_op_dbl(a, op, d, i);
+		}
+
+		uint32_t room[LBIG_LONG_DIGITS];
+		lbig y, r;
+		builtin_big(a->cell[i], &y, room);
+		switch (op) {
+			case OP_ADD: lbig_add(&r, &acc, &y); break;
+			case OP_SUB: lbig_sub(&r, &acc, &y); break;
+			case OP_MUL: lbig_mul(&r, &acc, &y); break;
+			case OP_DIV:
+				if (y.len == 0) {
+					lbig_free(&acc);
+					lval_del(a);
+					return lval_err("Division by Zero!");
+				}
+				lbig_divmod(&r, NULL, &acc, &y);
+			break;
+		}
+		lbig_free(&acc);
+		acc = r;
+	}
+
+	lval_del(a);
+	return lval_bignum(&acc);
+}
+
+static inline lval* builtin_op(lenv* e, lval* a, int op){
 
 	/* Ensure all arguments are numbers */
 	for (int i = 0; i < a->count; i++) {
-		if(a->cell[i]->type != LVAL_NUM) {
-			LASSERT_TYPE(op, a, i, LVAL_NUM);
+		if(!builtin_is_num(a->cell[i])) {
+			LASSERT_TYPE(op_names[op], a, i, LVAL_NUM);
 		}
 	}
 
-	/* Pop the first element */
-	lval* x = lval_pop(a, 0);
+	/* Accumulate into a plain number, the result is boxed once at the end */
+	lval** cell = a->cell;
+	int count = a->count;
+	uint32_t room[LBIG_LONG_DIGITS];
+	lbig big;
+	if (cell[0]->type == LVAL_DBL) { return builtin_op_dbl(a, op, cell[0]->dbl, 1); }
+	if (cell[0]->type == LVAL_BIGNUM) { return builtin_op_big(a, op, &cell[0]->big, 1); }
+	long x = cell[0]->num;
+	long r;
 
 	/* If no arguments and sub then perform unary negation */
-	if ( (strcmp(op, "-") == 0) && (a->count == 0) ) {
-		x->num = -x->num;
+	if (op == OP_SUB && count == 1) {
+		if (__builtin_sub_overflow(0, x, &r)) {
+			lbig_view(&big, x, room);
+			return builtin_op_big(a, op, &big, 1);
+		}
+		lval_del(a);
+		return lval_num(r);
 	}
 
-	/* While there are still elements remaining */
-	while (a->count > 0) {
-
-		/* Pop the next element */
-		lval* y = lval_pop(a, 0);
-
-		if ( strcmp(op, "+") == 0 ) { x->num += y->num; }
-		if ( strcmp(op, "-") == 0 ) { x->num -= y->num; }
-		if ( strcmp(op, "*") == 0 ) { x->num *= y->num; }
-		if ( strcmp(op, "/") == 0 ) { 
-			if (y->num == 0) {
-				lval_del(x); 
-				lval_del(y);
-				x = lval_err("Division by Zero!"); 
-				break;
-			}
-			x->num /= y->num; 
+	/* For each remaining element, until one is not a long or overflows */
+	int i = 1;
+	for (; i < count && cell[i]->type == LVAL_NUM; i++) {
+		long y = cell[i]->num;
+		int overflow;
+		switch (op) {
+			case OP_ADD: overflow = __builtin_add_overflow(x, y, &r); break;
+			case OP_SUB: overflow = __builtin_sub_overflow(x, y, &r); break;
+			case OP_MUL: overflow = __builtin_mul_overflow(x, y, &r); break;
+			default:
+				if (y == 0) {
+					lval_del(a);
+					return lval_err("Division by Zero!");
+				}
+				overflow = x == LONG_MIN && y == -1;
+				r = overflow ? 0 : x / y;
+			break;
 		}
+		if (overflow) { break; }
+		x = r;
+	}
 
-		lval_del(y);
+	if (i < count && cell[i]->type == LVAL_DBL) { return builtin_op_dbl(a, op, (double)x, i); }
+	if (i < count) {
+		lbig_view(&big, x, room);
+		return builtin_op_big(a, op, &big, i);
 	}
 
 	lval_del(a);
 
-	return x;
+	return lval_num(x);
 }
 
 lval* builtin_add(lenv* e, lval* a) {
-	return builtin_op(e, a, "+");
+	return builtin_op(e, a, OP_ADD);
 }
 
 lval* builtin_sub(lenv* e, lval* a) {
-	return builtin_op(e, a, "-");
+	return builtin_op(e, a, OP_SUB);
 }
 
 lval* builtin_mul(lenv* e, lval* a) {
-	return builtin_op(e, a, "*");
+	return builtin_op(e, a, OP_MUL);
 }
 
 lval* builtin_div(lenv* e, lval* a) {
-	return builtin_op(e, a, "/");
+	return builtin_op(e, a, OP_DIV);
 }
 
 lval* builtin_mod(lenv* e, lval* a) {
 	// Assert two arguments, both numbers
 	LASSERT_NUM("% (modulo)", a, 2);
-	LASSERT_TYPE("% (modulo)", a, 0, LVAL_NUM);
-	LASSERT_TYPE("% (modulo)", a, 1, LVAL_NUM);
-	LASSERT(a, a->cell[1]->num != 0, 
-		"%d mod 0 is undefined", 
-		a->cell[0]->num);
+	if (!builtin_is_num(a->cell[0])) { LASSERT_TYPE("% (modulo)", a, 0, LVAL_NUM); }
+	if (!builtin_is_num(a->cell[1])) { LASSERT_TYPE("% (modulo)", a, 1, LVAL_NUM); }
 
-	// Create output
-	lval* v = lval_num(a->cell[0]->num % a->cell[1]->num);
+	if (a->cell[1]->type == LVAL_NUM && a->cell[1]->num == 0) {
+		lval* err = a->cell[0]->type == LVAL_NUM ? lval_err("%li mod 0 is undefined", a->cell[0]->num)
+			: a->cell[0]->type == LVAL_DBL ? lval_err("%g mod 0 is undefined", a->cell[0]->dbl)
+			: lval_err("Bignum mod 0 is undefined");
+		lval_del(a);
+		return err;
+	}
+
+	// Create output, -1 divides everything, LONG_MIN included
+	lval* v;
+	if (a->cell[0]->type == LVAL_DBL || a->cell[1]->type == LVAL_DBL) {
+		double y = builtin_dbl(a->cell[1]);
+		LASSERT(a, y != 0, "%g mod 0 is undefined", builtin_dbl(a->cell[0]));
+		v = lval_dbl(fmod(builtin_dbl(a->cell[0]), y));
+	} else if (a->cell[0]->type == LVAL_NUM && a->cell[1]->type == LVAL_NUM) {
+		v = lval_num(a->cell[1]->num == -1 ? 0 : a->cell[0]->num % a->cell[1]->num);
+	} else {
+		uint32_t xroom[LBIG_LONG_DIGITS], yroom[LBIG_LONG_DIGITS];
+		lbig x, y, r;
+		builtin_big(a->cell[0], &x, xroom);
+		builtin_big(a->cell[1], &y, yroom);
+		lbig_divmod(NULL, &r, &x, &y);
+		v = lval_bignum(&r);
+	}
 
 	// Cleanup and return
 	lval_del(a);
 	return v;
 }
 
+/* 'x' to the power 'n' by repeated squaring, in Bignums */
+static lval* builtin_exp_big(lbig* x, long n) {
+	lbig acc, base, t;
+	uint32_t room[LBIG_LONG_DIGITS];
+	lbig_view(&t, 1, room);
+	lbig_copy(&acc, &t);
+	lbig_copy(&base, x);
+
+	while (n > 0) {
+		if (n & 1) { lbig_mul(&t, &acc, &base); lbig_free(&acc); acc = t; }
+		n >>= 1;
+		if (n > 0) { lbig_mul(&t, &base, &base); lbig_free(&base); base = t; }
+	}
+
+	lbig_free(&base);
+	return lval_bignum(&acc);
+}
+
 lval* builtin_exp(lenv* e, lval* a) {
-	// Assert two argyments, both numbers
+	// Assert two argyments, both numbers, the exponent a plain one
+	// unless either is a Double
 	LASSERT_NUM("^ (exp)", a, 2);
-	LASSERT_TYPE("^ (exp)", a, 0, LVAL_NUM);
+	if (!builtin_is_num(a->cell[0])) { LASSERT_TYPE("^ (exp)", a, 0, LVAL_NUM); }
+	if (a->cell[0]->type == LVAL_DBL || a->cell[1]->type == LVAL_DBL) {
+		if (!builtin_is_num(a->cell[1])) { LASSERT_TYPE("^ (exp)", a, 1, LVAL_NUM); }
+		lval* v = lval_dbl(pow(builtin_dbl(a->cell[0]), builtin_dbl(a->cell[1])));
+		lval_del(a);
+		return v;
+	}
 	LASSERT_TYPE("^ (exp)", a, 1, LVAL_NUM);
 
-	// Create output
-	lval* v = lval_num( pow(a->cell[0]->num, a->cell[1]->num) );
+	lval* base = a->cell[0];
+	long n = a->cell[1]->num;
+
+	// Negative powers truncate to 0, but for those of 1 and -1
+	if (n < 0) {
+		int unit = base->type == LVAL_NUM && (base->num == 1 || base->num == -1);
+		LASSERT(a, base->type != LVAL_NUM || base->num != 0, "Division by Zero!");
+		lval* v = lval_num(unit ? (n % 2 == 0 ? 1 : base->num) : 0);
+		lval_del(a);
+		return v;
+	}
+
+	// Square and multiply in a long for as long as it fits
+	lval* v = NULL;
+	if (base->type == LVAL_NUM) {
+		long x = base->num;
+		long r = 1;
+		int overflow = 0;
+		for (long k = n; k > 0 && !overflow;) {
+			if (k & 1) { overflow = __builtin_mul_overflow(r, x, &r); }
+			k >>= 1;
+			if (k > 0 && !overflow) { overflow = __builtin_mul_overflow(x, x, &x); }
+		}
+		if (!overflow) { v = lval_num(r); }
+	}
+
+	if (v == NULL) {
+		uint32_t room[LBIG_LONG_DIGITS];
+		lbig x;
+		builtin_big(base, &x, room);
+		v = builtin_exp_big(&x, n);
+	}
 
 	// Cleanup and return
 	lval_del(a);
@@ -203,8 +383,15 @@ lval* builtin_head(lenv* e, lval* a) {
 	/* Otherwise take first argument */
 	lval* v = lval_take(a, 0);
 
-	/* Delete all elements that are not head and return */
-	while (v->count > 1) { lval_del(lval_pop(v, 1)); }
+	/* If shared build a new list around the head instead */
+	if (v->ref > 1 || v->vec->ref > 1) {
+		lval* x = lval_add(lval_qexpr(), lval_copy(v->cell[0]));
+		lval_del(v);
+		return x;
+	}
+
+	/* Delete all elements that are not head, from the end, and return */
+	while (v->count > 1) { lval_del(lval_pop(v, v->count-1)); }
 	return v;
 }
 
@@ -215,7 +402,7 @@ lval* builtin_tail(lenv* e, lval* a) {
 	LASSERT_NOT_EMPTY("tail", a, 0);
 
 	/* Otherwise take first argument */
-	lval* v = lval_take(a, 0);
+	lval* v = lval_unshare(lval_take(a, 0));
 
 	/* Delete first element and return */
 	lval_del(lval_pop(v, 0));
@@ -223,17 +410,23 @@ lval* builtin_tail(lenv* e, lval* a) {
 }
 
 lval* builtin_list(lenv* e, lval* a) {
-	a->type = LVAL_QEXPR;
+	lalloc_retype(a, LVAL_QEXPR);
 	return a;
 }
 
-lval* builtin_eval(lenv* e, lval* a) {
+/* Return the expression 'eval' evaluates, or an error. Used directly */
+/* for calls in tail position so the evaluation does not nest.       */
+lval* builtin_eval_tail(lenv* e, lval* a) {
 	LASSERT_NUM("eval", a, 1);
 	LASSERT_TYPE("eval", a, 0, LVAL_QEXPR);
 
-	lval* x = lval_take(a, 0);
-	x->type = LVAL_SEXPR;
-	return lval_eval(e, x);
+	lval* x = lval_unshare(lval_take(a, 0));
+	lalloc_retype(x, LVAL_SEXPR);
+	return x;
+}
+
+lval* builtin_eval(lenv* e, lval* a) {
+	return lval_eval(e, builtin_eval_tail(e, a));
 }
 
 lval* builtin_join(lenv* e, lval* a) {
@@ -252,27 +445,68 @@ lval* builtin_join(lenv* e, lval* a) {
 	return x;
 }
 
+/* The Numbers from the first argument to the second, both included, */
+/* built in one pass                                                 */
+lval* builtin_range(lenv* e, lval* a) {
+	LASSERT_NUM("range", a, 2);
+	LASSERT_TYPE("range", a, 0, LVAL_NUM);
+	LASSERT_TYPE("range", a, 1, LVAL_NUM);
+
+	long from = a->cell[0]->num;
+	long to = a->cell[1]->num;
+	LASSERT(a, to < from || (unsigned long)to - (unsigned long)from < INT_MAX,
+		"Function 'range' passed a range too long for a list.");
+
+	int count = to < from ? 0 : (int)((unsigned long)to - (unsigned long)from) + 1;
+	lval* l = lval_qexpr();
+	for (int i = 0; i < count; i++) { l = lval_add(l, lval_num(from + i)); }
+	lval_del(a);
+	return l;
+}
+
 /*====================================== Ordering Operators ======================================*/
 
-lval* builtin_ord(lenv* e, lval* a, char* op) {
+static inline lval* builtin_ord(lenv* e, lval* a, int op) {
 	// Assert two arguments, both numbers
-	LASSERT_NUM(op, a, 2);
-	LASSERT_TYPE(op, a, 0, LVAL_NUM);
-	LASSERT_TYPE(op, a, 1, LVAL_NUM);
-
-	// Based on operator simply perform that comparison
-	int r;
-	if (strcmp(op, ">") == 0) {
-		r = (a->cell[0]->num > a->cell[1]->num);
-	}
-	if (strcmp(op, "<") == 0) {
-		r = (a->cell[0]->num < a->cell[1]->num);
+	LASSERT_NUM(op_names[op], a, 2);
+	if (!builtin_is_num(a->cell[0])) { LASSERT_TYPE(op_names[op], a, 0, LVAL_NUM); }
+	if (!builtin_is_num(a->cell[1])) { LASSERT_TYPE(op_names[op], a, 1, LVAL_NUM); }
+
+	// Doubles compare as doubles, so that nan is unordered
+	if (a->cell[0]->type == LVAL_DBL || a->cell[1]->type == LVAL_DBL) {
+		double x = builtin_dbl(a->cell[0]);
+		double y = builtin_dbl(a->cell[1]);
+		int r;
+		switch (op) {
+			case OP_GT: r = x > y;  break;
+			case OP_LT: r = x < y;  break;
+			case OP_GE: r = x >= y; break;
+			default:    r = x <= y; break;
+		}
+		lval_del(a);
+		return lval_num(r);
 	}
-	if (strcmp(op, ">=") == 0) {
-		r = (a->cell[0]->num >= a->cell[1]->num);
+
+	// Based on operator simply perform that comparison, of the order of
+	// Bignums as -1, 0 or 1
+	long x, y;
+	if (a->cell[0]->type == LVAL_NUM && a->cell[1]->type == LVAL_NUM) {
+		x = a->cell[0]->num;
+		y = a->cell[1]->num;
+	} else {
+		uint32_t xroom[LBIG_LONG_DIGITS], yroom[LBIG_LONG_DIGITS];
+		lbig bx, by;
+		builtin_big(a->cell[0], &bx, xroom);
+		builtin_big(a->cell[1], &by, yroom);
+		x = lbig_cmp(&bx, &by);
+		y = 0;
 	}
-	if (strcmp(op, "<=") == 0) {
-		r = (a->cell[0]->num <= a->cell[1]->num);
+	int r;
+	switch (op) {
+		case OP_GT: r = x > y;  break;
+		case OP_LT: r = x < y;  break;
+		case OP_GE: r = x >= y; break;
+		default:    r = x <= y; break;
 	}
 
 	// Cleanup and return
@@ -282,85 +516,120 @@ lval* builtin_ord(lenv* e, lval* a, char* op) {
 }
 
 lval* builtin_gt(lenv* e, lval* a){
-	return builtin_ord(e, a, ">");
+	return builtin_ord(e, a, OP_GT);
 }
 
 lval* builtin_lt(lenv* e, lval* a){
-	return builtin_ord(e, a, "<");
+	return builtin_ord(e, a, OP_LT);
 }
 
 lval* builtin_ge(lenv* e, lval* a){
-	return builtin_ord(e, a, ">=");
+	return builtin_ord(e, a, OP_GE);
 }
 
 lval* builtin_le(lenv* e, lval* a){
-	return builtin_ord(e, a, "<=");
+	return builtin_ord(e, a, OP_LE);
 }
 
 /*====================================== Equality Operators ======================================*/
 
-lval* builtin_cmp(lenv* e, lval* a, char* op){
+static inline lval* builtin_cmp(lenv* e, lval* a, int op){
 	// Assert two arguments
-	LASSERT_NUM(op, a, 2);
+	LASSERT_NUM(op_names[op], a, 2);
 
+	// Numbers of any type compare by value, as with the ordering operators,
+	// so a Double equals the Number it holds and nan equals nothing.
+	// Anything else is equal when the same structure.
+	lval* x = a->cell[0];
+	lval* y = a->cell[1];
 	int r;
-	if (strcmp(op, "==") == 0) {
-		r = lval_eq(a->cell[0], a->cell[1]);
-	}
-	if (strcmp(op, "!=") == 0) {
-		r = !lval_eq(a->cell[0], a->cell[1]);
+	if (!builtin_is_num(x) || !builtin_is_num(y)) {
+		r = lval_eq(x, y);
+	} else if (x->type == LVAL_DBL || y->type == LVAL_DBL) {
+		r = builtin_dbl(x) == builtin_dbl(y);
+	} else if (x->type == LVAL_NUM && y->type == LVAL_NUM) {
+		r = x->num == y->num;
+	} else {
+		uint32_t xroom[LBIG_LONG_DIGITS], yroom[LBIG_LONG_DIGITS];
+		lbig bx, by;
+		builtin_big(x, &bx, xroom);
+		builtin_big(y, &by, yroom);
+		r = lbig_cmp(&bx, &by) == 0;
 	}
+	if (op == OP_NE) { r = !r; }
 
 	lval_del(a);
 	return lval_num(r);
 }
 
 lval* builtin_eq(lenv* e, lval* a){
-	return builtin_cmp(e, a, "==");
+	return builtin_cmp(e, a, OP_EQ);
 }
 
 lval* builtin_ne(lenv* e, lval* a){
-	return builtin_cmp(e, a, "!=");
+	return builtin_cmp(e, a, OP_NE);
 }
 
 /*==================================== Conditional branching ====================================*/
 
-lval* builtin_if(lenv* e, lval* a) {
+/* Return the branch 'if' evaluates, or an error. Used directly */
+/* for calls in tail position so the evaluation does not nest. */
+lval* builtin_if_tail(lenv* e, lval* a) {
 	/* Assert Three Arguments, First is number, followed by two Q-expr */
 	LASSERT_NUM("if", a, 3);
 	LASSERT_TYPE("if", a, 0, LVAL_NUM);	
 	LASSERT_TYPE("if", a, 1, LVAL_QEXPR);
 	LASSERT_TYPE("if", a, 2, LVAL_QEXPR);	
 
-	/* Mark both Expressions as evaluable (i.e. S-expr) */
-	lval* x;
-	a->cell[1]->type = LVAL_SEXPR;
-	a->cell[2]->type = LVAL_SEXPR;
+	/* If condition is true take first expression, otherwise second */
+	lval* x = lval_unshare(lval_pop(a, a->cell[0]->num ? 1 : 2));
 
-	if (a->cell[0]->num) {
-		/* If condition is true evaluate first expression */
-		x = lval_eval(e, lval_pop(a, 1));
-	} else {
-		x = lval_eval(e, lval_pop(a, 2));
-	}
+	/* Mark the chosen Expression as evaluable (i.e. S-expr) */
+	lalloc_retype(x, LVAL_SEXPR);
 
 	// Cleanup and return
 	lval_del(a);
 	return x;
 }
 
+lval* builtin_if(lenv* e, lval* a) {
+	return lval_eval(e, builtin_if_tail(e, a));
+}
+
+/* Read every expression in file 'filename', with lread or the mpc grammar */
+/* as --reader selects. A failure gives an error holding the message.     */
+static lval* builtin_load_read(char* filename) {
+	if (lread_enabled) { return lread_file(filename); }
+
+	/* The grammar reads from memory rather than seeking around the file */
+	lsource s;
+	if (!lread_open(filename, &s)) { return lval_err("%s: error: Unable to open file!\n", filename); }
+
+	mpc_result_t r;
+	int ok = mpc_nparse(filename, s.src, s.len, Lispy, &r);
+	lread_close(&s);
+	if (ok) {
+		lval* expr = lval_read(r.output);
+		mpc_ast_delete(r.output);
+		return expr;
+	}
+
+	/* Get Parse Error as String */
+	char* err_msg = mpc_err_string(r.error);
+	mpc_err_delete(r.error);
+	lval* err = lval_err("%s", err_msg);
+	free(err_msg);
+	return err;
+}
+
 lval* builtin_load (lenv* e, lval* a) {
 	// Assert 1 String argument
 	LASSERT_NUM("load", a, 1);
 	LASSERT_TYPE("load", a, 0, LVAL_STR);
 
 	/* Parse File given by string name */
-	mpc_result_t r;
-	if (mpc_parse_contents(a->cell[0]->str, Lispy, &r)) {
-
-		/* Read contents */
-		lval* expr = lval_read(r.output);
-		mpc_ast_delete(r.output);
+	lval* expr = builtin_load_read(a->cell[0]->str);
+	if (expr->type != LVAL_ERR) {
 
 		/* Evaluate each Expression */
 		while (expr->count) {
@@ -378,13 +647,9 @@ lval* builtin_load (lenv* e, lval* a) {
 		return lval_sexpr();
 
 	} else {
-		/* Get Parse Error as String */
-		char* err_msg = mpc_err_string(r.error);
-		mpc_err_delete(r.error);
-
-		/* Create new error message using it */
-		lval* err = lval_err("Could not load Library %s", err_msg);
-		free(err_msg);
+		/* Create new error message using the parse error */
+		lval* err = lval_err("Could not load Library %s", expr->err);
+		lval_del(expr);
 		lval_del(a);
 
 		/* Cleanup and return error */
@@ -418,4 +683,55 @@ lval* builtin_error (lenv* e, lval* a) {
 	// Cleanup and return
 	lval_del(a);
 	return err;
-}
\ No newline at end of file
+}
+
+lval* builtin_serialize (lenv* e, lval* a) {
+	// Assert a filename and the value to write there
+	LASSERT_NUM("serialize", a, 2);
+	LASSERT_TYPE("serialize", a, 0, LVAL_STR);
+
+	lval* x = lserial_save(a->cell[0]->str, a->cell[1]);
+	lval_del(a);
+	return x;
+}
+
+lval* builtin_deserialize (lenv* e, lval* a) {
+	// Assert the filename of a value written by serialize
+	LASSERT_NUM("deserialize", a, 1);
+	LASSERT_TYPE("deserialize", a, 0, LVAL_STR);
+
+	lval* x = lserial_load(a->cell[0]->str);
+	lval_del(a);
+	return x;
+}
+
+/* A name and value pair for memstats */
+static lval* builtin_stat(char* name, long value) {
+	return lval_add(lval_add(lval_qexpr(), lval_sym(name)), lval_num(value));
+}
+
+lval* builtin_memstats (lenv* e, lval* a) {
+	/* Arguments are ignored, call as (memstats ()) */
+	lval_del(a);
+
+	/* Take the counters before building the result changes them */
+	lstats s = lalloc_stats;
+
+	lval* live = lval_qexpr();
+	for (int t = 0; t < LVAL_TYPES; t++) {
+		live = lval_add(live, builtin_stat(ltype_name(t), s.live[t]));
+	}
+
+	lval* x = lval_qexpr();
+	x = lval_add(x, builtin_stat("lvals", s.lvals));
+	x = lval_add(x, builtin_stat("lenvs", s.lenvs));
+	x = lval_add(x, builtin_stat("bytes", s.bytes));
+	x = lval_add(x, builtin_stat("peak-lvals", s.lvals_peak));
+	x = lval_add(x, builtin_stat("peak-lenvs", s.lenvs_peak));
+	x = lval_add(x, builtin_stat("peak-bytes", s.bytes_peak));
+	x = lval_add(x, builtin_stat("lval-allocs", s.lval_allocs));
+	x = lval_add(x, builtin_stat("lenv-allocs", s.lenv_allocs));
+	x = lval_add(x, builtin_stat("copies", s.copies));
+	return lval_add(x, lval_add(lval_add(lval_qexpr(), lval_sym("live")), live));
+}
+
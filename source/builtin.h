@@ -9,11 +9,7 @@ typedef struct lval lval;
 
 /*===================================== Declared Functions =====================================*/
 
-/* Builtin Infrastructure */
-lval* builtin(lenv* e, lval* a, char* func);
-
 /* Variable Setters */
-lval* builtin_var(lenv* e, lval* a, char* func);
 lval* builtin_def(lenv* e, lval* a);
 lval* builtin_put(lenv* e, lval* a);
 
@@ -25,10 +21,11 @@ lval* builtin_list(lenv* e, lval* a);
 lval* builtin_head(lenv* e, lval* a);
 lval* builtin_tail(lenv* e, lval* a);
 lval* builtin_eval(lenv* e, lval* a);
+lval* builtin_eval_tail(lenv* e, lval* a);
 lval* builtin_join(lenv* e, lval* a);
+lval* builtin_range(lenv* e, lval* a);
 
 /* Arithmetic Operators */
-lval* builtin_op(lenv* e, lval* a, char* op);
 lval* builtin_add(lenv* e, lval* a);
 lval* builtin_sub(lenv* e, lval* a);
 lval* builtin_mul(lenv* e, lval* a);
@@ -37,24 +34,34 @@ lval* builtin_div(lenv* e, lval* a);
 lval* builtin_mod(lenv* e, lval* a);
 lval* builtin_exp(lenv* e, lval* a);
 
+/* Whether 'v' is a Number, Bignum or Double, and its value as a double */
+int builtin_is_num(lval* v);
+double builtin_dbl(lval* v);
+
 /* Ordering Operators */
-lval* builtin_ord(lenv* e, lval* a, char* op);
 lval* builtin_gt(lenv* e, lval* a);
 lval* builtin_lt(lenv* e, lval* a);
 lval* builtin_ge(lenv* e, lval* a);
 lval* builtin_le(lenv* e, lval* a);
 
 /* Equality Operators */
-lval* builtin_cmp(lenv* e, lval* a, char* op);
 lval* builtin_eq(lenv* e, lval* a);
 lval* builtin_ne(lenv* e, lval* a);
 
 /* Conditional branching */
 lval* builtin_if(lenv* e, lval* a);
+lval* builtin_if_tail(lenv* e, lval* a);
 
 /* Load, print, and error functions */
 lval* builtin_load  (lenv* e, lval* a);
 lval* builtin_print (lenv* e, lval* a);
 lval* builtin_error (lenv* e, lval* a);
 
+/* Binary files of values, see lserial.h */
+lval* builtin_serialize   (lenv* e, lval* a);
+lval* builtin_deserialize (lenv* e, lval* a);
+
+/* Memory statistics, see lalloc.h */
+lval* builtin_memstats (lenv* e, lval* a);
+
 #endif
\ No newline at end of file
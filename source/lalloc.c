@@ -0,0 +1,161 @@
+
+/*========================================= Includes =========================================*/
+
+// Standard Include
+#include <stdio.h>
+#include <stdlib.h>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+// Local Include
+#include "lenviron.h"
+#include "lvalue.h"
+
+// Header Include
+#include "lalloc.h"
+
+/*===================================== Struct Definitions =====================================*/
+
+/* Number of blocks carved from each slab */
+#define LALLOC_SLAB_BLOCKS 1024
+
+/* A free block holds the link to the next free block */
+typedef struct lblock {
+	struct lblock* next;
+} lblock;
+
+/* Slabs are chained through a header so they can be released */
+typedef struct lslab {
+	struct lslab* next;
+} lslab;
+
+typedef struct lpool {
+	size_t size;
+	lblock* free;
+	lslab* slabs;
+} lpool;
+
+/* Blocks are rounded up so every block stays pointer aligned */
+#define LALLOC_ROUND(s) (((s) + sizeof(void*) - 1) & ~(sizeof(void*) - 1))
+
+static lpool lval_pool = { LALLOC_ROUND(sizeof(lval)), NULL, NULL };
+static lpool lenv_pool = { LALLOC_ROUND(sizeof(lenv)), NULL, NULL };
+
+lstats lalloc_stats;
+int lalloc_print = 0;
+
+/*===================================== Defined Functions =====================================*/
+
+#ifndef LISPY_SYSTEM_MALLOC
+/* Carve a new slab into blocks and push them all onto the freelist */
+static void lpool_refill(lpool* p) {
+	lslab* slab = malloc(sizeof(lslab) + p->size * LALLOC_SLAB_BLOCKS);
+	slab->next = p->slabs;
+	p->slabs = slab;
+
+	char* block = (char*)(slab + 1);
+	for (int i = 0; i < LALLOC_SLAB_BLOCKS; i++) {
+		lblock* b = (lblock*)(block + p->size * i);
+		b->next = p->free;
+		p->free = b;
+	}
+}
+#endif
+
+static void* lpool_alloc(lpool* p) {
+	lalloc_bytes(p->size);
+#ifdef LISPY_SYSTEM_MALLOC
+	return malloc(p->size);
+#else
+	if (p->free == NULL) { lpool_refill(p); }
+	lblock* b = p->free;
+	p->free = b->next;
+	return b;
+#endif
+}
+
+static void lpool_free(lpool* p, void* x) {
+	lalloc_bytes(-(long)p->size);
+#ifdef LISPY_SYSTEM_MALLOC
+	free(x);
+#else
+	lblock* b = x;
+	b->next = p->free;
+	p->free = b;
+#endif
+}
+
+static void lpool_cleanup(lpool* p) {
+	while (p->slabs != NULL) {
+		lslab* next = p->slabs->next;
+		free(p->slabs);
+		p->slabs = next;
+	}
+	p->free = NULL;
+}
+
+lval* lalloc_lval(int type) {
+	lalloc_stats.lval_allocs++;
+	lalloc_stats.live[type]++;
+	if (++lalloc_stats.lvals > lalloc_stats.lvals_peak) {
+		lalloc_stats.lvals_peak = lalloc_stats.lvals;
+	}
+	return lpool_alloc(&lval_pool);
+}
+
+void lalloc_free_lval(lval* v) {
+	lalloc_stats.live[v->type]--;
+	lalloc_stats.lvals--;
+	lpool_free(&lval_pool, v);
+}
+
+lenv* lalloc_lenv(void) {
+	lalloc_stats.lenv_allocs++;
+	if (++lalloc_stats.lenvs > lalloc_stats.lenvs_peak) {
+		lalloc_stats.lenvs_peak = lalloc_stats.lenvs;
+	}
+	return lpool_alloc(&lenv_pool);
+}
+
+void lalloc_free_lenv(lenv* e) {
+	lalloc_stats.lenvs--;
+	lpool_free(&lenv_pool, e);
+}
+
+/*===================================== Memory Statistics =====================================*/
+
+void lalloc_retype(lval* v, int type) {
+	lalloc_stats.live[v->type]--;
+	lalloc_stats.live[type]++;
+	v->type = type;
+}
+
+void lalloc_print_stats(void) {
+	lstats* s = &lalloc_stats;
+	fprintf(stderr, "memstats: %lu lvals and %lu lenvs allocated, peak %ld lvals, %ld lenvs, %ld bytes\n",
+		s->lval_allocs, s->lenv_allocs, s->lvals_peak, s->lenvs_peak, s->bytes_peak);
+	fprintf(stderr, "memstats: %lu lval copies\n", s->copies);
+
+#ifndef _WIN32
+	/* Includes the parsers and everything else outside the counters */
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	fprintf(stderr, "memstats: peak rss %ld KB\n", usage.ru_maxrss);
+#endif
+
+	/* Everything should be freed by the time this is called */
+	if (s->lvals == 0 && s->lenvs == 0 && s->bytes == 0) {
+		fprintf(stderr, "memstats: no leaks\n");
+		return;
+	}
+	fprintf(stderr, "memstats: leaked %ld lvals, %ld lenvs, %ld bytes\n", s->lvals, s->lenvs, s->bytes);
+	for (int t = 0; t < LVAL_TYPES; t++) {
+		if (s->live[t] != 0) { fprintf(stderr, "memstats:   %ld %s\n", s->live[t], ltype_name(t)); }
+	}
+}
+
+void lalloc_cleanup(void) {
+	lpool_cleanup(&lval_pool);
+	lpool_cleanup(&lenv_pool);
+}
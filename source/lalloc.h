@@ -0,0 +1,64 @@
+#ifndef LALLOC_HEADER
+#define LALLOC_HEADER
+
+// Local Include
+#include "lisputils.h"
+
+/* Forward declare dependencies */
+struct lenv;
+struct lval;
+typedef struct lenv lenv;
+typedef struct lval lval;
+
+/*===================================== Memory Statistics =====================================*/
+
+/* Counters kept as values and environments are made and freed, and as */
+/* values are copied. Bytes count the structs and the cell buffers,    */
+/* strings and binding tables they own. Reported by the memstats       */
+/* builtin and --memstats.                                             */
+typedef struct lstats {
+	long live[LVAL_TYPES]; /* lvals alive by type */
+	long lvals;
+	long lvals_peak;
+	long lenvs;
+	long lenvs_peak;
+	long bytes;
+	long bytes_peak;
+	unsigned long lval_allocs;
+	unsigned long lenv_allocs;
+	unsigned long copies;      /* lvals duplicated to be written to, as */
+	                           /* lval_copy only takes a reference      */
+} lstats;
+
+extern lstats lalloc_stats;
+
+/* Count 'n' bytes allocated, or freed if negative */
+static inline void lalloc_bytes(long n) {
+	lalloc_stats.bytes += n;
+	if (lalloc_stats.bytes > lalloc_stats.bytes_peak) { lalloc_stats.bytes_peak = lalloc_stats.bytes; }
+}
+
+/* Change the type of 'v', keeping the live counts right */
+void lalloc_retype(lval* v, int type);
+
+/* Print the counters to stderr, with what is still alive as leaked. */
+/* Printed at exit when lalloc_print is set, by --memstats.          */
+extern int lalloc_print;
+void lalloc_print_stats(void);
+
+/*===================================== Declared Functions =====================================*/
+
+/* lval and lenv structs come from per-type slab pools. Each pool carves  */
+/* fixed size blocks out of large slabs and recycles freed blocks through */
+/* its own freelist, so the evaluator's many short lived temporaries are */
+/* reused straight away instead of going back through malloc and free.   */
+/* Define LISPY_SYSTEM_MALLOC to use malloc directly, e.g. for valgrind. */
+lval* lalloc_lval(int type);
+void  lalloc_free_lval(lval* v);
+lenv* lalloc_lenv(void);
+void  lalloc_free_lenv(lenv* e);
+
+/* Release every slab, only safe once nothing is live */
+void lalloc_cleanup(void);
+
+#endif
@@ -0,0 +1,396 @@
+/*========================================= Includes =========================================*/
+
+// Standard Include
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Local Include
+#include "lalloc.h"
+
+// Header Include
+#include "lbignum.h"
+
+/*===================================== Magnitudes =====================================*/
+
+/* Below this many digits the schoolbook method is faster than Karatsuba */
+#define LBIG_KARATSUBA 32
+
+/* Digits are used without leading zeros wherever a length is compared */
+static int mag_len(const uint32_t* a, int n) {
+	while (n > 0 && a[n - 1] == 0) { n--; }
+	return n;
+}
+
+static int mag_cmp(const uint32_t* a, int an, const uint32_t* b, int bn) {
+	if (an != bn) { return an < bn ? -1 : 1; }
+	for (int i = an - 1; i >= 0; i--) {
+		if (a[i] != b[i]) { return a[i] < b[i] ? -1 : 1; }
+	}
+	return 0;
+}
+
+/* r = a + b, with room for one digit more than the longer of them. */
+/* Returns that length. 'r' may be 'a' or 'b'.                      */
+static int mag_add(uint32_t* r, const uint32_t* a, int an, const uint32_t* b, int bn) {
+	if (an < bn) {
+		const uint32_t* t = a; a = b; b = t;
+		int n = an; an = bn; bn = n;
+	}
+
+	uint64_t c = 0;
+	int i = 0;
+	for (; i < bn; i++) { c += (uint64_t)a[i] + b[i]; r[i] = (uint32_t)c; c >>= 32; }
+	for (; i < an; i++) { c += a[i]; r[i] = (uint32_t)c; c >>= 32; }
+	r[an] = (uint32_t)c;
+	return an + 1;
+}
+
+/* r = a - b where a >= b, with room for 'an' digits. 'r' may be 'a'. */
+static void mag_sub(uint32_t* r, const uint32_t* a, int an, const uint32_t* b, int bn) {
+	uint64_t borrow = 0;
+	for (int i = 0; i < an; i++) {
+		uint64_t t = (uint64_t)a[i] - (i < bn ? b[i] : 0) - borrow;
+		r[i] = (uint32_t)t;
+		borrow = t >> 63;
+	}
+}
+
+/* Add 'a' into the 'rn' digits of 'r', starting at digit 'off' */
+static void mag_add_at(uint32_t* r, int rn, const uint32_t* a, int an, int off) {
+	uint64_t c = 0;
+	int i = 0;
+	for (; i < an; i++) { c += (uint64_t)r[off + i] + a[i]; r[off + i] = (uint32_t)c; c >>= 32; }
+	for (i += off; c != 0 && i < rn; i++) { c += r[i]; r[i] = (uint32_t)c; c >>= 32; }
+}
+
+static void mag_mul_school(uint32_t* r, const uint32_t* a, int an, const uint32_t* b, int bn) {
+	memset(r, 0, sizeof(uint32_t) * (an + bn));
+	for (int i = 0; i < an; i++) {
+		uint64_t ai = a[i];
+		if (ai == 0) { continue; }
+
+		uint64_t c = 0;
+		for (int j = 0; j < bn; j++) {
+			c += ai * b[j] + r[i + j];
+			r[i + j] = (uint32_t)c;
+			c >>= 32;
+		}
+		r[i + bn] = (uint32_t)c;
+	}
+}
+
+/* r = a * b, writing all an + bn digits of 'r' */
+static void mag_mul(uint32_t* r, const uint32_t* a, int an, const uint32_t* b, int bn) {
+	if (an < bn) {
+		const uint32_t* t = a; a = b; b = t;
+		int n = an; an = bn; bn = n;
+	}
+
+	if (bn < LBIG_KARATSUBA) { mag_mul_school(r, a, an, b, bn); return; }
+
+	/* Much longer 'a' is multiplied a slice the length of 'b' at a time */
+	if (2 * bn <= an) {
+		memset(r, 0, sizeof(uint32_t) * (an + bn));
+		uint32_t* t = malloc(sizeof(uint32_t) * 2 * bn);
+		for (int off = 0; off < an; off += bn) {
+			int n = an - off < bn ? an - off : bn;
+			mag_mul(t, a + off, n, b, bn);
+			mag_add_at(r, an + bn, t, n + bn, off);
+		}
+		free(t);
+		return;
+	}
+
+	/* Karatsuba: split each at digit m, a = a1 B^m + a0 and b likewise, */
+	/* then ab = z2 B^2m + z1 B^m + z0 with z0 = a0 b0, z2 = a1 b1 and   */
+	/* z1 = (a0 + a1)(b0 + b1) - z0 - z2, three products instead of four */
+	int m = an / 2;
+	int a1n = an - m;
+	int b1n = bn - m;
+	mag_mul(r, a, m, b, m);
+	mag_mul(r + 2 * m, a + m, a1n, b + m, b1n);
+
+	uint32_t* sa = malloc(sizeof(uint32_t) * (a1n + 1));
+	uint32_t* sb = malloc(sizeof(uint32_t) * ((b1n > m ? b1n : m) + 1));
+	int san = mag_add(sa, a, m, a + m, a1n);
+	int sbn = mag_add(sb, b, m, b + m, b1n);
+
+	uint32_t* z1 = malloc(sizeof(uint32_t) * (san + sbn));
+	mag_mul(z1, sa, san, sb, sbn);
+	int z1n = san + sbn;
+	mag_sub(z1, z1, z1n, r, mag_len(r, 2 * m));
+	mag_sub(z1, z1, z1n, r + 2 * m, mag_len(r + 2 * m, an + bn - 2 * m));
+	mag_add_at(r, an + bn, z1, mag_len(z1, z1n), m);
+
+	free(sa);
+	free(sb);
+	free(z1);
+}
+
+/* Divide 'u' by the single digit 'v' into 'q', returning the remainder */
+static uint32_t mag_divmod_digit(uint32_t* q, const uint32_t* u, int m, uint32_t v) {
+	uint64_t rem = 0;
+	for (int i = m - 1; i >= 0; i--) {
+		uint64_t cur = (rem << 32) | u[i];
+		q[i] = (uint32_t)(cur / v);
+		rem = cur % v;
+	}
+	return (uint32_t)rem;
+}
+
+/* Long division of the 'm' digits of 'u' by the 'n' of 'v', m >= n >= 2,  */
+/* into the m - n + 1 digits of 'q' and the 'n' of 'rem', by Knuth's       */
+/* algorithm D. Both are shifted so the top digit of 'v' has its top bit  */
+/* set, which keeps each estimated quotient digit at most two too large.  */
+static void mag_divmod(uint32_t* q, uint32_t* rem, const uint32_t* u, int m, const uint32_t* v, int n) {
+	int s = __builtin_clz(v[n - 1]);
+	uint32_t* vn = malloc(sizeof(uint32_t) * n);
+	uint32_t* un = malloc(sizeof(uint32_t) * (m + 1));
+
+	for (int i = n - 1; i > 0; i--) { vn[i] = (v[i] << s) | (s ? v[i - 1] >> (32 - s) : 0); }
+	vn[0] = v[0] << s;
+	un[m] = s ? u[m - 1] >> (32 - s) : 0;
+	for (int i = m - 1; i > 0; i--) { un[i] = (u[i] << s) | (s ? u[i - 1] >> (32 - s) : 0); }
+	un[0] = u[0] << s;
+
+	for (int j = m - n; j >= 0; j--) {
+		/* Estimate the quotient digit from the top two digits */
+		uint64_t num = ((uint64_t)un[j + n] << 32) | un[j + n - 1];
+		uint64_t qhat = num / vn[n - 1];
+		uint64_t rhat = num % vn[n - 1];
+		while ((qhat >> 32) != 0 || qhat * vn[n - 2] > ((rhat << 32) | un[j + n - 2])) {
+			qhat--;
+			rhat += vn[n - 1];
+			if ((rhat >> 32) != 0) { break; }
+		}
+
+		/* Subtract qhat times the divisor */
+		uint64_t carry = 0;
+		uint64_t borrow = 0;
+		for (int i = 0; i < n; i++) {
+			uint64_t p = qhat * vn[i] + carry;
+			carry = p >> 32;
+			uint64_t t = (uint64_t)un[i + j] - (uint32_t)p - borrow;
+			un[i + j] = (uint32_t)t;
+			borrow = t >> 63;
+		}
+		uint64_t t = (uint64_t)un[j + n] - carry - borrow;
+		un[j + n] = (uint32_t)t;
+		q[j] = (uint32_t)qhat;
+
+		/* Rarely one too many, so add the divisor back */
+		if ((t >> 63) != 0) {
+			q[j]--;
+			uint64_t c = 0;
+			for (int i = 0; i < n; i++) {
+				c += (uint64_t)un[i + j] + vn[i];
+				un[i + j] = (uint32_t)c;
+				c >>= 32;
+			}
+			un[j + n] += (uint32_t)c;
+		}
+	}
+
+	for (int i = 0; i < n - 1; i++) { rem[i] = (un[i] >> s) | (s ? un[i + 1] << (32 - s) : 0); }
+	rem[n - 1] = un[n - 1] >> s;
+
+	free(vn);
+	free(un);
+}
+
+/*===================================== Values =====================================*/
+
+static void lbig_alloc(lbig* r, int cap) {
+	if (cap < 1) { cap = 1; }
+	r->d = malloc(sizeof(uint32_t) * cap);
+	r->cap = cap;
+	r->len = 0;
+	r->sign = 1;
+	lalloc_bytes((long)sizeof(uint32_t) * cap);
+}
+
+/* Drop leading zero digits, zero being positive */
+static void lbig_norm(lbig* r) {
+	r->len = mag_len(r->d, r->len);
+	if (r->len == 0) { r->sign = 1; }
+}
+
+void lbig_free(lbig* b) {
+	if (b->cap > 0) {
+		lalloc_bytes(-(long)sizeof(uint32_t) * b->cap);
+		free(b->d);
+	}
+	b->d = NULL;
+	b->len = b->cap = 0;
+}
+
+void lbig_view(lbig* b, long x, uint32_t room[LBIG_LONG_DIGITS]) {
+	uint64_t u = x < 0 ? 0 - (uint64_t)x : (uint64_t)x;
+	room[0] = (uint32_t)u;
+	room[1] = (uint32_t)(u >> 32);
+	b->sign = x < 0 ? -1 : 1;
+	b->len = room[1] ? 2 : room[0] ? 1 : 0;
+	b->cap = 0;
+	b->d = room;
+}
+
+void lbig_copy(lbig* r, lbig* a) {
+	lbig_alloc(r, a->len);
+	memcpy(r->d, a->d, sizeof(uint32_t) * a->len);
+	r->len = a->len;
+	r->sign = a->sign;
+}
+
+void lbig_parse(lbig* r, char* s, long n) {
+	static const uint32_t pow10[] = {
+		1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+	};
+
+	int neg = n > 0 && s[0] == '-';
+	s += neg;
+	n -= neg;
+
+	/* Each 9 decimal digits take less than one 32 bit digit */
+	lbig_alloc(r, (int)(n / 9 + 2));
+
+	/* Multiply in 9 digits at a time, the first group taking the rest */
+	for (long i = 0; i < n;) {
+		int k = i == 0 && n % 9 != 0 ? (int)(n % 9) : 9;
+		uint64_t c = 0;
+		for (int j = 0; j < k; j++) { c = c * 10 + (uint64_t)(s[i + j] - '0'); }
+		i += k;
+
+		for (int j = 0; j < r->len; j++) {
+			c += (uint64_t)r->d[j] * pow10[k];
+			r->d[j] = (uint32_t)c;
+			c >>= 32;
+		}
+		if (c != 0) { r->d[r->len++] = (uint32_t)c; }
+	}
+
+	r->sign = neg ? -1 : 1;
+	lbig_norm(r);
+}
+
+int lbig_to_long(lbig* b, long* x) {
+	if (b->len > 2) { return 0; }
+	uint64_t u = (b->len > 0 ? b->d[0] : 0) | (b->len > 1 ? (uint64_t)b->d[1] << 32 : 0);
+
+	if (b->sign > 0) {
+		if (u > (uint64_t)LONG_MAX) { return 0; }
+		*x = (long)u;
+	} else {
+		if (u > (uint64_t)LONG_MAX + 1) { return 0; }
+		*x = u == 0 ? 0 : -(long)(u - 1) - 1;
+	}
+	return 1;
+}
+
+double lbig_to_double(lbig* b) {
+	double x = 0;
+	for (int i = b->len - 1; i >= 0; i--) { x = x * 4294967296.0 + b->d[i]; }
+	return b->sign < 0 ? -x : x;
+}
+
+char* lbig_str(lbig* b) {
+	if (b->len == 0) {
+		char* s = malloc(2);
+		strcpy(s, "0");
+		return s;
+	}
+
+	/* Divide down by 10^9, collecting groups of 9 decimal digits */
+	uint32_t* t = malloc(sizeof(uint32_t) * b->len);
+	memcpy(t, b->d, sizeof(uint32_t) * b->len);
+	int tn = b->len;
+	uint32_t* groups = malloc(sizeof(uint32_t) * (2 * b->len + 1));
+	int count = 0;
+	do {
+		groups[count++] = mag_divmod_digit(t, t, tn, 1000000000);
+		tn = mag_len(t, tn);
+	} while (tn > 0);
+
+	char* s = malloc(9 * count + 3);
+	int len = sprintf(s, "%s%u", b->sign < 0 ? "-" : "", groups[count - 1]);
+	for (int i = count - 2; i >= 0; i--) { len += sprintf(s + len, "%09u", groups[i]); }
+
+	free(t);
+	free(groups);
+	return s;
+}
+
+int lbig_cmp(lbig* a, lbig* b) {
+	if (a->sign != b->sign) { return a->sign < b->sign ? -1 : 1; }
+	int c = mag_cmp(a->d, a->len, b->d, b->len);
+	return a->sign > 0 ? c : -c;
+}
+
+/* r = a + b, with 'bsign' the sign to give 'b' */
+static void lbig_add_signed(lbig* r, lbig* a, lbig* b, int bsign) {
+	if (a->sign == bsign) {
+		lbig_alloc(r, (a->len > b->len ? a->len : b->len) + 1);
+		r->len = mag_add(r->d, a->d, a->len, b->d, b->len);
+		r->sign = a->sign;
+	} else if (mag_cmp(a->d, a->len, b->d, b->len) >= 0) {
+		lbig_alloc(r, a->len);
+		mag_sub(r->d, a->d, a->len, b->d, b->len);
+		r->len = a->len;
+		r->sign = a->sign;
+	} else {
+		lbig_alloc(r, b->len);
+		mag_sub(r->d, b->d, b->len, a->d, a->len);
+		r->len = b->len;
+		r->sign = bsign;
+	}
+	lbig_norm(r);
+}
+
+void lbig_add(lbig* r, lbig* a, lbig* b) {
+	lbig_add_signed(r, a, b, b->sign);
+}
+
+void lbig_sub(lbig* r, lbig* a, lbig* b) {
+	lbig_add_signed(r, a, b, -b->sign);
+}
+
+void lbig_mul(lbig* r, lbig* a, lbig* b) {
+	if (a->len == 0 || b->len == 0) { lbig_alloc(r, 1); return; }
+
+	lbig_alloc(r, a->len + b->len);
+	mag_mul(r->d, a->d, a->len, b->d, b->len);
+	r->len = a->len + b->len;
+	r->sign = a->sign * b->sign;
+	lbig_norm(r);
+}
+
+void lbig_divmod(lbig* q, lbig* r, lbig* a, lbig* b) {
+	lbig qt, rt;
+
+	if (mag_cmp(a->d, a->len, b->d, b->len) < 0) {
+		/* Smaller than the divisor, so all remainder */
+		lbig_alloc(&qt, 1);
+		lbig_copy(&rt, a);
+	} else if (b->len == 1) {
+		lbig_alloc(&qt, a->len);
+		lbig_alloc(&rt, 1);
+		rt.d[0] = mag_divmod_digit(qt.d, a->d, a->len, b->d[0]);
+		qt.len = a->len;
+		rt.len = 1;
+	} else {
+		lbig_alloc(&qt, a->len - b->len + 1);
+		lbig_alloc(&rt, b->len);
+		mag_divmod(qt.d, rt.d, a->d, a->len, b->d, b->len);
+		qt.len = a->len - b->len + 1;
+		rt.len = b->len;
+	}
+
+	qt.sign = a->sign * b->sign;
+	rt.sign = a->sign;
+	lbig_norm(&qt);
+	lbig_norm(&rt);
+
+	if (q != NULL) { *q = qt; } else { lbig_free(&qt); }
+	if (r != NULL) { *r = rt; } else { lbig_free(&rt); }
+}
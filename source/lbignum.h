@@ -0,0 +1,54 @@
+#ifndef LBIGNUM_HEADER
+#define LBIGNUM_HEADER
+
+// Standard Include
+#include <stdint.h>
+
+/*===================================== Struct Definition =====================================*/
+
+/* An integer of any size, as a sign and a magnitude of 'len' 32 bit   */
+/* digits, least significant first, with no leading zero digits. Zero */
+/* has no digits. 'cap' is the number of digits allocated, 0 for a    */
+/* view of digits owned elsewhere, which is never freed.             */
+typedef struct lbig {
+	int sign;
+	int len;
+	int cap;
+	uint32_t* d;
+} lbig;
+
+/* Room for the digits of any long, for views made by lbig_view */
+#define LBIG_LONG_DIGITS 2
+
+/*===================================== Declared Functions =====================================*/
+
+/* 'b' as a view of 'x', its digits in 'room' */
+void lbig_view(lbig* b, long x, uint32_t room[LBIG_LONG_DIGITS]);
+
+/* Read the decimal digits 's', 'n' of them, with an optional leading '-' */
+void lbig_parse(lbig* r, char* s, long n);
+
+/* The value of 'b', if it fits in a long. Returns 0 if it does not. */
+int lbig_to_long(lbig* b, long* x);
+
+/* The nearest double to 'b', or an infinity if too large */
+double lbig_to_double(lbig* b);
+
+/* Decimal digits of 'b', to be freed by the caller */
+char* lbig_str(lbig* b);
+
+int lbig_cmp(lbig* a, lbig* b);
+
+/* Arithmetic writes a new value into 'r', which must not be an operand. */
+/* Division truncates, with the remainder taking the sign of 'a', as C's */
+/* / and % do. Either 'q' or 'r' may be NULL. 'b' must not be zero.      */
+void lbig_add(lbig* r, lbig* a, lbig* b);
+void lbig_sub(lbig* r, lbig* a, lbig* b);
+void lbig_mul(lbig* r, lbig* a, lbig* b);
+void lbig_divmod(lbig* q, lbig* r, lbig* a, lbig* b);
+void lbig_copy(lbig* r, lbig* a);
+
+/* Free the digits of 'b', unless it is a view */
+void lbig_free(lbig* b);
+
+#endif
@@ -0,0 +1,263 @@
+
+/*========================================= Includes =========================================*/
+
+// Standard Include
+#include <stdlib.h>
+
+// Local Include
+#include "lisputils.h"
+#include "lenviron.h"
+#include "lsymbol.h"
+#include "lvalue.h"
+
+// Header Include
+#include "lcompile.h"
+
+/*===================================== Code Construction =====================================*/
+
+/* Stack depth while compiling, used to size the VM's value stack */
+static int depth = 0;
+
+/* Layout of the frame the body runs in, with every formal bound */
+static lenv* frame = NULL;
+
+static void lcode_emit(lcode* c, int op) {
+	if (c->count == c->cap) {
+		c->cap = c->cap ? c->cap * 2 : 16;
+		c->ops = realloc(c->ops, sizeof(int) * c->cap);
+	}
+	c->ops[c->count++] = op;
+}
+
+/* Add a constant, taking ownership of 'v', and return its index */
+static int lcode_const(lcode* c, lval* v) {
+	if (c->nconsts == c->constcap) {
+		c->constcap = c->constcap ? c->constcap * 2 : 8;
+		c->consts = realloc(c->consts, sizeof(lval*) * c->constcap);
+	}
+	c->consts[c->nconsts] = v;
+	return c->nconsts++;
+}
+
+/* Add an empty inline cache and return its index */
+static int lcode_cache(lcode* c) {
+	c->caches = realloc(c->caches, sizeof(lcache) * (c->ncaches + 1));
+	c->caches[c->ncaches].version = 0;
+	c->caches[c->ncaches].fun = NULL;
+	return c->ncaches++;
+}
+
+static void lcode_push(lcode* c, int n) {
+	depth += n;
+	if (depth > c->max_stack) { c->max_stack = depth; }
+}
+
+/*===================================== Expression Compiler =====================================*/
+
+static void lcode_compile_sexpr(lcode* c, lval** cells, int count, int tail);
+
+/* Compile 'v', a call in tail position if 'tail' is set */
+static void lcode_compile_expr(lcode* c, lval* v, int tail) {
+	switch (v->type) {
+		/* Formals are read from their slot in the lambda's frame. Other */
+		/* symbols are bound by callers, so are resolved when run, from  */
+		/* the global slot they have now if no caller rebinds them.      */
+		case LVAL_SYM: {
+			int slot = lenv_slot(frame, v->sym);
+			if (slot >= 0) {
+				lcode_emit(c, LOP_LOCAL);
+			} else {
+				lenv* g = lenv_global();
+				slot = g != NULL ? lenv_slot(g, v->sym) : -1;
+				lcode_emit(c, LOP_GLOBAL);
+			}
+			lcode_emit(c, lcode_const(c, lval_copy(v)));
+			lcode_emit(c, slot);
+			lcode_push(c, 1);
+		} break;
+
+		/* S-Expressions are evaluated */
+		case LVAL_SEXPR:
+			lcode_compile_sexpr(c, v->cell, v->count, tail);
+		break;
+
+		/* All other lval types evaluate to themselves */
+		default:
+			lcode_emit(c, LOP_CONST);
+			lcode_emit(c, lcode_const(c, lval_copy(v)));
+			lcode_push(c, 1);
+		break;
+	}
+}
+
+/* Is this (if cond {then} {else}) */
+static int lcode_is_if(lval** cells, int count) {
+	static char* sym_if = NULL;
+	if (sym_if == NULL) { sym_if = lsym_intern("if"); }
+
+	return count == 4
+		&& cells[0]->type == LVAL_SYM && cells[0]->sym == sym_if
+		&& cells[2]->type == LVAL_QEXPR
+		&& cells[3]->type == LVAL_QEXPR;
+}
+
+/* Emit a call of every cell, the general case of an S-expression */
+static void lcode_compile_call(lcode* c, lval** cells, int count, int tail) {
+
+	/* A head that is not a formal is looked up through a cache */
+	int global = cells[0]->type == LVAL_SYM && lenv_slot(frame, cells[0]->sym) < 0;
+	if (!global) {
+		for (int i = 0; i < count; i++) { lcode_compile_expr(c, cells[i], 0); }
+		lcode_emit(c, tail ? LOP_TAILCALL : LOP_CALL);
+		lcode_emit(c, count);
+		depth -= count - 1;
+		return;
+	}
+
+	/* Arguments without calls cannot rebind anything, so the head */
+	/* can be looked up after them, by the call itself.            */
+	int pure = 1;
+	for (int i = 1; i < count; i++) {
+		if (cells[i]->type == LVAL_SEXPR) { pure = 0; }
+	}
+
+	if (!pure) {
+		lcode_emit(c, LOP_GFUN);
+		lcode_emit(c, lcode_const(c, lval_copy(cells[0])));
+		lcode_emit(c, lcode_cache(c));
+		lcode_push(c, 1);
+	}
+	for (int i = 1; i < count; i++) { lcode_compile_expr(c, cells[i], 0); }
+
+	if (pure) {
+		lcode_emit(c, tail ? LOP_TAILCALLG : LOP_CALLG);
+		lcode_emit(c, lcode_const(c, lval_copy(cells[0])));
+		lcode_emit(c, lcode_cache(c));
+		lcode_emit(c, count - 1);
+		depth -= count - 2;
+	} else {
+		lcode_emit(c, tail ? LOP_TAILCALL : LOP_CALL);
+		lcode_emit(c, count);
+		depth -= count - 1;
+	}
+}
+
+/* Compile cells as they would be evaluated as an S-expression, */
+/* a call in tail position if 'tail' is set                     */
+static void lcode_compile_sexpr(lcode* c, lval** cells, int count, int tail) {
+
+	/* Empty Expression evaluates to itself */
+	if (count == 0) {
+		lcode_emit(c, LOP_CONST);
+		lcode_emit(c, lcode_const(c, lval_sexpr()));
+		lcode_push(c, 1);
+		return;
+	}
+
+	/* Single Expression evaluates to its only element, */
+	/* which is in tail position if the expression is   */
+	if (count == 1) {
+		lcode_compile_expr(c, cells[0], tail);
+		return;
+	}
+
+	/* Anything but a literal 'if' is a call */
+	if (!lcode_is_if(cells, count)) {
+		lcode_compile_call(c, cells, count, tail);
+		return;
+	}
+
+	/* An 'if' with literal branches compiles to jumps, guarded by */
+	/* a check that 'if' still means the builtin when it is run.   */
+	int base = depth;
+
+	lcode_emit(c, LOP_IFGUARD);
+	lcode_emit(c, lcode_const(c, lval_copy(cells[0])));
+	lcode_emit(c, lcode_cache(c));
+	int guard = c->count;
+	lcode_emit(c, 0);
+
+	/* Condition */
+	lcode_compile_expr(c, cells[1], 0);
+	lcode_emit(c, LOP_TEST);
+	int test = c->count;
+	lcode_emit(c, 0);
+	lcode_emit(c, 0);
+	depth--;
+
+	/* Branches are Q-expressions evaluated as S-expressions, */
+	/* in tail position if the 'if' is                        */
+	lcode_compile_sexpr(c, cells[2]->cell, cells[2]->count, tail);
+	lcode_emit(c, LOP_JUMP);
+	int then_end = c->count;
+	lcode_emit(c, 0);
+
+	depth = base;
+	c->ops[test] = c->count;
+	lcode_compile_sexpr(c, cells[3]->cell, cells[3]->count, tail);
+	lcode_emit(c, LOP_JUMP);
+	int else_end = c->count;
+	lcode_emit(c, 0);
+
+	/* Fallback when 'if' has been rebound */
+	depth = base;
+	c->ops[guard] = c->count;
+	lcode_compile_call(c, cells, count, tail);
+
+	/* Every path leaves one value */
+	c->ops[test + 1] = c->count;
+	c->ops[then_end] = c->count;
+	c->ops[else_end] = c->count;
+}
+
+/*===================================== Defined Functions =====================================*/
+
+/* Bind every formal into a frame in the order lval_call binds them, */
+/* including those given to a partial application, to find the slot */
+/* of each one                                                       */
+static lenv* lcode_frame(lval* f) {
+	static char* amp = NULL;
+	if (amp == NULL) { amp = lsym_intern("&"); }
+
+	lenv* e = lenv_frame(f->formals->count);
+	lval* placeholder = lval_num(0);
+	for (int i = 0; i < f->formals->count; i++) {
+		if (f->formals->cell[i]->sym == amp) { continue; }
+		lenv_put(e, f->formals->cell[i], placeholder);
+	}
+	lval_del(placeholder);
+	return e;
+}
+
+lcode* lcode_compile(lval* f) {
+	lcode* c = malloc(sizeof(lcode));
+	c->ref = 1;
+	c->count = 0;
+	c->cap = 0;
+	c->ops = NULL;
+	c->nconsts = 0;
+	c->constcap = 0;
+	c->consts = NULL;
+	c->max_stack = 0;
+	c->ncaches = 0;
+	c->caches = NULL;
+
+	/* The body is evaluated as an S-expression and its value returned */
+	depth = 0;
+	frame = lcode_frame(f);
+	lcode_compile_sexpr(c, f->body->cell, f->body->count, 1);
+	lcode_emit(c, LOP_RETURN);
+	lenv_del(frame);
+	frame = NULL;
+
+	return c;
+}
+
+void lcode_release(lcode* c) {
+	if (--c->ref > 0) { return; }
+	for (int i = 0; i < c->nconsts; i++) { lval_del(c->consts[i]); }
+	free(c->consts);
+	free(c->caches);
+	free(c->ops);
+	free(c);
+}
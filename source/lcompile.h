@@ -0,0 +1,66 @@
+#ifndef LCOMPILE_HEADER
+#define LCOMPILE_HEADER
+
+/* Forward declare dependencies */
+struct lval;
+typedef struct lval lval;
+
+/*====================================== Bytecode Format ======================================*/
+
+/* Lambda bodies are compiled to a flat array of ints for the stack VM in */
+/* lvm.c. Each instruction is an opcode followed by its operands.         */
+enum {
+	LOP_CONST,    /* k       push a copy of constant k                          */
+	LOP_LOCAL,    /* k s     push the lambda's own binding of symbol k, in slot s */
+	LOP_GLOBAL,   /* k s     push the value bound to symbol k, cached global slot s */
+	LOP_CALL,     /* n       call the n values on top of the stack, as (f a...) */
+	LOP_TAILCALL, /* n       as LOP_CALL, returning the call to lval_apply to make */
+	LOP_GFUN,     /* k c     push the function bound to symbol k, through cache c */
+	LOP_CALLG,    /* k c n   call symbol k's function, through cache c, with the */
+	              /*         n values on top of the stack as its arguments      */
+	LOP_TAILCALLG,/* k c n   as LOP_CALLG, returning the call to lval_apply to make */
+	LOP_IFGUARD,  /* k c L   jump to L unless symbol k is the builtin 'if', through cache c */
+	LOP_TEST,     /* L1 L2   pop a condition, jump to L1 if it is false, or     */
+	              /*         leave an error and jump to L2 if it is not a number */
+	LOP_JUMP,     /* L       jump to L                                          */
+	LOP_RETURN    /*         return the value on top of the stack               */
+};
+
+/*===================================== Struct Definition =====================================*/
+
+/* Inline cache of the function a call site's head symbol is bound to. */
+/* 'fun' is the global binding at 'version', and is not referenced.   */
+typedef struct lcache {
+	unsigned long version;
+	lval* fun;
+} lcache;
+
+/* Compiled code is shared by every copy of the lambda it belongs to */
+typedef struct lcode {
+	int ref;
+
+	/* Instructions */
+	int count;
+	int cap;
+	int* ops;
+
+	/* Constants referenced by instructions */
+	int nconsts;
+	int constcap;
+	lval** consts;
+
+	/* Inline caches of call sites */
+	int ncaches;
+	lcache* caches;
+
+	/* Deepest the value stack gets */
+	int max_stack;
+} lcode;
+
+/*===================================== Declared Functions =====================================*/
+
+/* Compile a lambda's body, a list whose cells are evaluated as an S-expression */
+lcode* lcode_compile(lval* f);
+void lcode_release(lcode* c);
+
+#endif
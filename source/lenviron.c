@@ -7,41 +7,113 @@
 #include <string.h>
 
 // Internal Includes
+#include "lisputils.h"
 #include "lvalue.h"
+#include "lsymbol.h"
+#include "lalloc.h"
 #include "builtin.h"
+#include "lpackbuiltin.h"
+#include "lprof.h"
 #include "lenviron.h"
 
 /*========================= Defined Functions =========================*/
 
+/* The environment holding the builtins, the root of every caller chain */
+static lenv* global = NULL;
+
+/* Starts above zero so a version of zero is never current */
+unsigned long lenv_global_version = 1;
+
+/* Find the slot holding 'k', or the empty slot it would be inserted at */
+static int lenv_find(lenv* e, char* k, unsigned long h) {
+	int mask = e->cap - 1;
+	int i = (int)(h & mask);
+
+	/* Linear probe until the symbol or an empty slot is found */
+	while (e->syms[i] != NULL && e->syms[i] != k) {
+		i = (i + 1) & mask;
+	}
+	return i;
+}
+
+/* Double the table size and re-insert every binding */
+static void lenv_grow(lenv* e) {
+	int old_cap = e->cap;
+	char** old_syms = e->syms;
+	lval** old_vals = e->vals;
+
+	e->cap = old_cap ? old_cap * 2 : 8;
+	e->syms = malloc((sizeof(char*) + sizeof(lval*)) * e->cap);
+	lalloc_bytes((long)(sizeof(char*) + sizeof(lval*)) * (e->cap - old_cap));
+	e->vals = (lval**)(e->syms + e->cap);
+	memset(e->syms, 0, sizeof(char*) * e->cap);
+
+	for (int i = 0; i < old_cap; i++) {
+		if (old_syms[i] == NULL) { continue; }
+		int j = lenv_find(e, old_syms[i], lsym_hash(old_syms[i]));
+		e->syms[j] = old_syms[i];
+		e->vals[j] = old_vals[i];
+	}
+
+	free(old_syms);
+}
 
 void lenv_put(lenv* e, lval* k, lval* v) {
 
-	/* Iterate over all items in environment */
-	/* This is to see if variable already exists */
-	for (int i = 0; i < e->count; i++ ) {
-
-		/* If variable is found delete item at that position */
-		/* And replace with variable supplied by user */
-		if (strcmp(e->syms[i], k->sym) == 0) {
-			lval_del(e->vals[i]);
-			e->vals[i] = lval_copy(v);
-			return;
-		}
+	/* Keep the load factor at or below 3/4 */
+	if ((e->count + 1) * 4 > e->cap * 3) { lenv_grow(e); }
+
+	/* Look for the variable, or the slot it should go in */
+	int i = lenv_find(e, k->sym, lsym_hash(k->sym));
+
+	/* Functions are profiled under the global name they are given */
+	if (lprof_enabled && e == global && v->type == LVAL_FUN) { lprof_name(v, k->sym); }
+
+	/* If variable is found delete item at that position */
+	/* And replace with variable supplied by user */
+	if (e->syms[i] != NULL) {
+		if (e == global) { lenv_global_version++; }
+		lval_del(e->vals[i]);
+		e->vals[i] = lval_copy(v);
+		return;
 	}
 
-	/* If no existing entry found allocate space for new entry */
+	/* Otherwise copy contents of lval into the empty slot */
+	/* The symbol is interned so it is shared, not copied */
 	e->count++;
-	e->vals = realloc(e->vals, sizeof(lval*) * e->count);
-	e->syms = realloc(e->syms, sizeof(char*) * e->count);
+	e->vals[i] = lval_copy(v);
+	e->syms[i] = k->sym;
+	lsym_bind(k->sym);
+
+}
+
+/* Every builtin added, under the name it was first added as, so a */
+/* builtin can be written out by name and found again when read    */
+#define LENV_BUILTINS_MAX 128
+static struct { char* name; lbuiltin func; } builtins[LENV_BUILTINS_MAX];
+static int builtins_count = 0;
 
-	/* Copy contents of lval and symbol string into new location */
-	e->vals[e->count-1] = lval_copy(v);
-	e->syms[e->count-1] = malloc(strlen(k->sym)+1);
-	strcpy(e->syms[e->count-1], k->sym);
+char* lenv_builtin_name(lbuiltin func) {
+	for (int i = 0; i < builtins_count; i++) {
+		if (builtins[i].func == func) { return builtins[i].name; }
+	}
+	return NULL;
+}
 
+lbuiltin lenv_builtin_func(char* name) {
+	for (int i = 0; i < builtins_count; i++) {
+		if (strcmp(builtins[i].name, name) == 0) { return builtins[i].func; }
+	}
+	return NULL;
 }
 
 void lenv_add_builtin(lenv* e, char* name, lbuiltin func) {
+	if (lenv_builtin_name(func) == NULL && builtins_count < LENV_BUILTINS_MAX) {
+		builtins[builtins_count].name = name;
+		builtins[builtins_count].func = func;
+		builtins_count++;
+	}
+
 	lval* k = lval_sym(name);
 	lval* v = lval_fun(func);
 	lenv_put(e,k,v);
@@ -59,10 +131,15 @@ void lenv_def(lenv* e, lval* k, lval* v) {
 
 void lenv_add_builtins(lenv* e){
 
+	/* This is the global environment */
+	global = e;
+
 	/* String Functions */
 	lenv_add_builtin(e, "load", builtin_load);
 	lenv_add_builtin(e, "error", builtin_error);
 	lenv_add_builtin(e, "print", builtin_print);
+	lenv_add_builtin(e, "serialize", builtin_serialize);
+	lenv_add_builtin(e, "deserialize", builtin_deserialize);
 
 	/* Variable Functions */
 	lenv_add_builtin(e, "\\",  builtin_lambda);
@@ -75,6 +152,7 @@ void lenv_add_builtins(lenv* e){
 	lenv_add_builtin(e, "tail", builtin_tail);
 	lenv_add_builtin(e, "eval", builtin_eval);
 	lenv_add_builtin(e, "join", builtin_join);
+	lenv_add_builtin(e, "range", builtin_range);
 
 	/* Mathematical Functions */
 	lenv_add_builtin(e, "+", builtin_add);
@@ -92,54 +170,104 @@ void lenv_add_builtins(lenv* e){
 	lenv_add_builtin(e, "<",  builtin_lt);
 	lenv_add_builtin(e, ">=", builtin_ge);
 	lenv_add_builtin(e, "<=", builtin_le);	
+
+	/* Packed Vector Functions */
+	lpack_add_builtins(e);
+
+	/* Memory Statistics */
+	lenv_add_builtin(e, "memstats", builtin_memstats);
+}
+
+/* Size the table so 'n' bindings fit without it growing. Slots are */
+/* then fixed as long as no more than 'n' symbols are bound.        */
+void lenv_reserve(lenv* e, int n) {
+	while (n * 4 > e->cap * 3) { lenv_grow(e); }
+}
+
+/* A new frame for a call, sized so 'n' bindings fit without it */
+/* growing. Each binding then has a fixed slot, see lcode_compile. */
+lenv* lenv_frame(int n) {
+	lenv* e = lenv_new();
+	lenv_reserve(e, n);
+	return e;
+}
+
+/* Index of the slot binding 'sym' in 'e' alone, or -1 if unbound */
+int lenv_slot(lenv* e, char* sym) {
+	if (e->count == 0) { return -1; }
+	int i = lenv_find(e, sym, lsym_hash(sym));
+	return e->syms[i] != NULL ? i : -1;
 }
 
-lenv* lenv_copy(lenv* e) {
-	lenv* n = malloc(sizeof(lenv));
-	n->par = e->par;
-	n->count = e->count;
-	n->syms = malloc(sizeof(char*) * n->count);
-	n->vals = malloc(sizeof(lval*) * n->count);
-	for (int i = 0; i < e->count; i++) {
-		n->syms[i] = malloc(strlen(e->syms[i]) + 1);
-		strcpy(n->syms[i], e->syms[i]);
-		n->vals[i] = lval_copy(e->vals[i]);
+/* Does 'e' bind every symbol bound in 'd' */
+int lenv_shadows(lenv* e, lenv* d) {
+	if (d->count > e->count) { return 0; }
+	for (int i = 0; i < d->cap; i++) {
+		if (d->syms[i] != NULL && lenv_slot(e, d->syms[i]) < 0) { return 0; }
 	}
-	return n;
+	return 1;
 }
 
-lval* lenv_get(lenv* e, lval* k) {
-	/* Iterate over all items in environment */
-	for (int i = 0; i < e->count; i++) {
-		/* Check if the stored string matches the symbol string */
-		/* If it does, return a copy of the value */
-		if (strcmp(e->syms[i], k->sym) == 0) {
-			return lval_copy(e->vals[i]);
-		}
+lenv* lenv_global(void) {
+	return global;
+}
+
+/* Find the value bound to an interned symbol without copying it */
+/* Returns NULL if the symbol is unbound                          */
+lval* lenv_lookup(lenv* e, char* sym) {
+	/* Nothing binds the symbol */
+	int binds = lsym_bindings(sym);
+	if (binds == 0) { return NULL; }
+
+	/* The hash is precomputed when the symbol is interned */
+	unsigned long h = lsym_hash(sym);
+
+	/* A symbol bound only in the global environment is found there */
+	/* without walking the caller chain                              */
+	if (binds == 1 && global != NULL && global->count > 0) {
+		int i = lenv_find(global, sym, h);
+		if (global->syms[i] != NULL) { return global->vals[i]; }
 	}
-	/* If no symbol found check in parent */
-	if(e->par != NULL) {
-		return lenv_get(e->par, k);
-	} else {
-	return lval_err("Unbound Symbol '%s'!", k->sym);
+
+	for (; e != NULL; e = e->par) {
+		/* Skip environments with nothing bound */
+		if (e->count == 0) { continue; }
+
+		/* If the symbol is bound here, return the value */
+		int i = lenv_find(e, sym, h);
+		if (e->syms[i] != NULL) { return e->vals[i]; }
 	}
+
+	return NULL;
+}
+
+lval* lenv_get(lenv* e, lval* k) {
+	/* If the symbol is bound, return a copy of the value */
+	lval* v = lenv_lookup(e, k->sym);
+	if (v != NULL) { return lval_copy(v); }
+
+	/* If no symbol found in any parent it is unbound */
+	return lval_err("Unbound Symbol '%s'!", k->sym);
 }
 
 lenv* lenv_new(void) {
-	lenv* e = malloc(sizeof(lenv));
+	lenv* e = lalloc_lenv();
 	e->par = NULL;
 	e->count = 0;
+	e->cap = 0;
 	e->syms = NULL;
 	e->vals = NULL;
 	return e;
 }
 
 void lenv_del (lenv* e) {
-	for(int i = 0; i < e->count; i++) {
-		free(e->syms[i]);
+	if (e == global) { global = NULL; lenv_global_version++; }
+	for(int i = 0; i < e->cap; i++) {
+		if (e->syms[i] == NULL) { continue; }
+		lsym_unbind(e->syms[i]);
 		lval_del(e->vals[i]);
 	}
+	lalloc_bytes(-(long)(sizeof(char*) + sizeof(lval*)) * e->cap);
 	free(e->syms);
-	free(e->vals);
-	free(e);
-}
\ No newline at end of file
+	lalloc_free_lenv(e);
+}
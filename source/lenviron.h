@@ -1,31 +1,53 @@
-#ifndef LENVIRONMENT_HEADER
-#define LENVIRONMENT_HEADER
-
-/* Forward declare dependencies */
-struct lenv;
-struct lval;
-typedef struct lenv lenv;
-typedef struct lval lval;
-typedef lval*(*lbuiltin)(lenv*, lval*);
-
-/*===================================== Struct Definition =====================================*/
-
-struct lenv {
-	lenv* par;
-	int count;
-	char** syms;
-	lval** vals;
-};
-
-/*===================================== Declared Functions =====================================*/
-
-lenv* lenv_new(void);
-void  lenv_del (lenv* e); 
-lenv* lenv_copy(lenv* e);
-void lenv_def(lenv* e, lval* k, lval* v);
-void lenv_put(lenv* e, lval* k, lval* v);
-lval* lenv_get(lenv* e, lval* k);
-void lenv_add_builtin(lenv* e, char* name, lbuiltin func);
-void lenv_add_builtins(lenv* e);
-
-#endif
+#ifndef LENVIRONMENT_HEADER
+#define LENVIRONMENT_HEADER
+
+/* Forward declare dependencies */
+struct lenv;
+struct lval;
+typedef struct lenv lenv;
+typedef struct lval lval;
+typedef lval*(*lbuiltin)(lenv*, lval*);
+
+/*===================================== Struct Definition =====================================*/
+
+/* Bindings live in an open-addressing (linear probing) hash table.   */
+/* Keys are interned symbols, so they hash via their precomputed hash */
+/* and compare by pointer. An empty slot has sym NULL. The values    */
+/* follow the symbols in the same allocation.                         */
+struct lenv {
+	lenv* par;
+	int count;
+	int cap;
+	char** syms;
+	lval** vals;
+};
+
+/*===================================== Global Version =====================================*/
+
+/* Bumped whenever a global binding is replaced or the global environment */
+/* deleted. A global value found at one version is bound to the same      */
+/* symbol, and alive, for as long as the version is unchanged.            */
+extern unsigned long lenv_global_version;
+
+/*===================================== Declared Functions =====================================*/
+
+lenv* lenv_new(void);
+void  lenv_del (lenv* e); 
+void lenv_def(lenv* e, lval* k, lval* v);
+void lenv_put(lenv* e, lval* k, lval* v);
+lval* lenv_get(lenv* e, lval* k);
+lval* lenv_lookup(lenv* e, char* sym);
+void lenv_reserve(lenv* e, int n);
+lenv* lenv_frame(int n);
+int lenv_slot(lenv* e, char* sym);
+int lenv_shadows(lenv* e, lenv* d);
+lenv* lenv_global(void);
+void lenv_add_builtin(lenv* e, char* name, lbuiltin func);
+void lenv_add_builtins(lenv* e);
+
+/* The name a builtin was added under, or the builtin added under a */
+/* name, NULL if there is none                                      */
+char* lenv_builtin_name(lbuiltin func);
+lbuiltin lenv_builtin_func(char* name);
+
+#endif
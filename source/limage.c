@@ -0,0 +1,93 @@
+/*========================================= Includes =========================================*/
+
+// Standard Include
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Local Include
+#include "lisputils.h"
+#include "lvalue.h"
+#include "lenviron.h"
+#include "lserial.h"
+#include "lread.h"
+
+// Header Include
+#include "limage.h"
+
+/*===================================== Image Selection =====================================*/
+
+char* limage_out = NULL;
+char* limage_in = NULL;
+
+/*===================================== Defined Functions =====================================*/
+
+/* The magic, the version, the count of bindings, then each binding */
+/* as its symbol's name and its value                                */
+lval* limage_dump(lenv* e, char* filename) {
+	FILE* f = fopen(filename, "wb");
+	if (f == NULL) { return lval_err("Could not write image '%s'", filename); }
+
+	lbuf b;
+	lbuf_file(&b, f);
+	lbuf_text(&b, LIMAGE_MAGIC, strlen(LIMAGE_MAGIC));
+	lbuf_varint(&b, LIMAGE_VERSION);
+	lbuf_varint(&b, (unsigned long)e->count);
+
+	for (int i = 0; i < e->cap; i++) {
+		if (e->syms[i] == NULL) { continue; }
+		lbuf_text(&b, e->syms[i], strlen(e->syms[i]));
+		lserial_write(&b, e->vals[i]);
+	}
+	lbuf_flush(&b);
+	lbuf_free(&b);
+
+	int failed = ferror(f);
+	if (fclose(f) != 0 || failed) { return lval_err("Could not write image '%s'", filename); }
+	return lval_sexpr();
+}
+
+/* Bind each binding read from 'p', or give an error if one is malformed */
+static lval* limage_bind(lenv* e, char* filename, char* p, char* end) {
+	char magic[16];
+	char* m = lserial_text(&p, end, magic, sizeof(magic));
+	int is_image = m != NULL && strcmp(m, LIMAGE_MAGIC) == 0;
+	if (m != magic) { free(m); }
+	if (!is_image) { return lval_err("'%s' is not an image", filename); }
+
+	unsigned long version;
+	if (!lserial_varint(&p, end, &version) || version < 1 || version > LIMAGE_VERSION) {
+		return lval_err("Image '%s' is of another version", filename);
+	}
+
+	unsigned long count;
+	if (!lserial_varint(&p, end, &count)) { return lval_err("Image '%s' is malformed", filename); }
+
+	for (unsigned long i = 0; i < count; i++) {
+		char buf[64];
+		char* name = lserial_text(&p, end, buf, sizeof(buf));
+		lval* v = name != NULL ? lserial_read(&p, end) : NULL;
+		if (v == NULL) {
+			if (name != buf) { free(name); }
+			return lval_err("Image '%s' is malformed", filename);
+		}
+
+		lval* k = lval_sym(name);
+		lenv_put(e, k, v);
+		lval_del(k);
+		lval_del(v);
+		if (name != buf) { free(name); }
+	}
+
+	return lval_sexpr();
+}
+
+lval* limage_load(lenv* e, char* filename) {
+	lsource s;
+	if (!lread_open(filename, &s)) { return lval_err("Could not open image '%s'", filename); }
+
+	/* Bindings are read straight out of the mapped file */
+	lval* x = limage_bind(e, filename, s.src, s.src + s.len);
+	lread_close(&s);
+	return x;
+}
@@ -0,0 +1,34 @@
+#ifndef LIMAGE_HEADER
+#define LIMAGE_HEADER
+
+/* Forward declare dependencies */
+struct lenv;
+struct lval;
+typedef struct lenv lenv;
+typedef struct lval lval;
+
+/*===================================== Image Selection =====================================*/
+
+/* An image is a snapshot of the global environment, written by         */
+/* --dump-image=FILE once the files given are loaded, and read back by  */
+/* --image=FILE before they are, so the prelude and other libraries are */
+/* not read and evaluated again at every start. NULL when not given.    */
+extern char* limage_out;
+extern char* limage_in;
+
+/* Images start with this and the version of their format, which */
+/* follows that of the values in them, see lserial.h              */
+#define LIMAGE_MAGIC "lispyimg"
+#define LIMAGE_VERSION 4
+
+/*===================================== Declared Functions =====================================*/
+
+/* Write every binding of global environment 'e' to file 'filename', */
+/* giving an empty S-Expression or an error                          */
+lval* limage_dump(lenv* e, char* filename);
+
+/* Bind everything in the image in file 'filename' in 'e', giving an */
+/* empty S-Expression or an error if it cannot be read               */
+lval* limage_load(lenv* e, char* filename);
+
+#endif
@@ -15,6 +15,9 @@ char* ltype_name(int t) {
 		case LVAL_STR : return "String";
 		case LVAL_SEXPR : return "S-Expression";
 		case LVAL_QEXPR : return "Q-Expression";
+		case LVAL_BIGNUM : return "Bignum";
+		case LVAL_DBL : return "Double";
+		case LVAL_PACK : return "Packed Vector";
 		default: return "Unknown";			
 	}
 }
@@ -35,7 +35,11 @@ enum {
 	LVAL_STR, 
 	LVAL_FUN,
 	LVAL_SEXPR,
-	LVAL_QEXPR
+	LVAL_QEXPR,
+	LVAL_BIGNUM, /* A Number too large for a long */
+	LVAL_DBL,
+	LVAL_PACK, /* Packed vector of ints or doubles */
+	LVAL_TYPES /* Number of types */
 	};
 
 /* Error Related Functions */
@@ -0,0 +1,345 @@
+/*========================================= Includes =========================================*/
+
+// Standard Include
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Local Include
+#include "lalloc.h"
+
+// Header Include
+#include "lpack.h"
+
+/*===================================== Vector Registers =====================================*/
+
+/* The widest registers the compiler targets. Without -mavx (or         */
+/* -march=native) that is SSE2, on any x86-64, and on other machines the */
+/* scalar loops that finish every kernel do all of the work.             */
+#if defined(__AVX__)
+	#define VD __m256d
+	#define VD_LANES 4
+	#define VD_LOAD  _mm256_loadu_pd
+	#define VD_STORE _mm256_storeu_pd
+	#define VD_ZERO  _mm256_setzero_pd
+	#define VD_ADD   _mm256_add_pd
+	#define VD_SUB   _mm256_sub_pd
+	#define VD_MUL   _mm256_mul_pd
+	#define VD_DIV   _mm256_div_pd
+	#define VD_MIN   _mm256_min_pd
+	#define VD_MAX   _mm256_max_pd
+	#define VD_AND   _mm256_and_pd
+	#define VD_OR    _mm256_or_pd
+	#define VD_MASK  _mm256_movemask_pd
+	#define VD_ONES  _mm256_castsi256_pd(_mm256_set1_epi64x(1))
+	#define VD_GT(a, b) _mm256_cmp_pd(a, b, _CMP_GT_OQ)
+	#define VD_LT(a, b) _mm256_cmp_pd(a, b, _CMP_LT_OQ)
+	#define VD_GE(a, b) _mm256_cmp_pd(a, b, _CMP_GE_OQ)
+	#define VD_LE(a, b) _mm256_cmp_pd(a, b, _CMP_LE_OQ)
+	#define VD_EQ(a, b) _mm256_cmp_pd(a, b, _CMP_EQ_OQ)
+	#define VD_UNORD(a, b) _mm256_cmp_pd(a, b, _CMP_UNORD_Q)
+#elif defined(__SSE2__)
+	#define VD __m128d
+	#define VD_LANES 2
+	#define VD_LOAD  _mm_loadu_pd
+	#define VD_STORE _mm_storeu_pd
+	#define VD_ZERO  _mm_setzero_pd
+	#define VD_ADD   _mm_add_pd
+	#define VD_SUB   _mm_sub_pd
+	#define VD_MUL   _mm_mul_pd
+	#define VD_DIV   _mm_div_pd
+	#define VD_MIN   _mm_min_pd
+	#define VD_MAX   _mm_max_pd
+	#define VD_AND   _mm_and_pd
+	#define VD_OR    _mm_or_pd
+	#define VD_MASK  _mm_movemask_pd
+	#define VD_ONES  _mm_castsi128_pd(_mm_set1_epi64x(1))
+	#define VD_GT    _mm_cmpgt_pd
+	#define VD_LT    _mm_cmplt_pd
+	#define VD_GE    _mm_cmpge_pd
+	#define VD_LE    _mm_cmple_pd
+	#define VD_EQ    _mm_cmpeq_pd
+	#define VD_UNORD _mm_cmpunord_pd
+#endif
+
+/* 64 bit integer compares need AVX2, adds only SSE2 */
+#if defined(__AVX2__)
+	#define VI __m256i
+	#define VI_LANES 4
+	#define VI_LOAD(p)     _mm256_loadu_si256((const __m256i*)(p))
+	#define VI_STORE(p, v) _mm256_storeu_si256((__m256i*)(p), v)
+	#define VI_ZERO  _mm256_setzero_si256
+	#define VI_ADD   _mm256_add_epi64
+	#define VI_SUB   _mm256_sub_epi64
+	#define VI_AND   _mm256_and_si256
+	#define VI_ANDNOT _mm256_andnot_si256
+	#define VI_ONES  _mm256_set1_epi64x(1)
+	#define VI_GT    _mm256_cmpgt_epi64
+	#define VI_EQ    _mm256_cmpeq_epi64
+#elif defined(__SSE2__)
+	#define VI __m128i
+	#define VI_LANES 2
+	#define VI_LOAD(p)     _mm_loadu_si128((const __m128i*)(p))
+	#define VI_STORE(p, v) _mm_storeu_si128((__m128i*)(p), v)
+	#define VI_ZERO  _mm_setzero_si128
+	#define VI_ADD   _mm_add_epi64
+	#define VI_SUB   _mm_sub_epi64
+#endif
+
+/* Apply 'f' to whole registers of 'a' and 'b' into 'r', leaving 'i' at */
+/* the elements left over for the scalar loop after it                  */
+#ifdef VD
+	#define VD_LOOP(f) \
+		for (; i + VD_LANES <= n; i += VD_LANES) { VD_STORE(r + i, f(VD_LOAD(a + i), VD_LOAD(b + i))); }
+	#define VD_CMP_LOOP(f) \
+		for (; i + VD_LANES <= n; i += VD_LANES) { \
+			VD_STORE((double*)(r + i), VD_AND(f(VD_LOAD(a + i), VD_LOAD(b + i)), VD_ONES)); \
+		}
+#else
+	#define VD_LOOP(f)
+	#define VD_CMP_LOOP(f)
+#endif
+
+#ifdef VI
+	#define VI_LOOP(f) \
+		for (; i + VI_LANES <= n; i += VI_LANES) { VI_STORE(r + i, f(VI_LOAD(a + i), VI_LOAD(b + i))); }
+#else
+	#define VI_LOOP(f)
+#endif
+
+/*===================================== Storage =====================================*/
+
+void lpack_alloc(lpack* p, int kind, long count) {
+	long bytes = count > 0 ? count * 8 : 8;
+	p->kind = kind;
+	p->count = count;
+	p->data = malloc(bytes);
+	lalloc_bytes(bytes);
+}
+
+void lpack_copy(lpack* r, lpack* a) {
+	lpack_alloc(r, a->kind, a->count);
+	memcpy(r->data, a->data, a->count * 8);
+}
+
+void lpack_free(lpack* p) {
+	lalloc_bytes(-(p->count > 0 ? p->count * 8 : 8));
+	free(p->data);
+	p->data = NULL;
+	p->count = 0;
+}
+
+/*===================================== Element-wise =====================================*/
+
+static void lpack_arith_dbl(double* r, const double* a, const double* b, long n, int op) {
+	long i = 0;
+	switch (op) {
+		case LPACK_ADD: VD_LOOP(VD_ADD); for (; i < n; i++) { r[i] = a[i] + b[i]; } break;
+		case LPACK_SUB: VD_LOOP(VD_SUB); for (; i < n; i++) { r[i] = a[i] - b[i]; } break;
+		case LPACK_MUL: VD_LOOP(VD_MUL); for (; i < n; i++) { r[i] = a[i] * b[i]; } break;
+		case LPACK_DIV: VD_LOOP(VD_DIV); for (; i < n; i++) { r[i] = a[i] / b[i]; } break;
+	}
+}
+
+/* Done in unsigned arithmetic so overflow wraps around */
+static void lpack_arith_int(int64_t* r, const int64_t* a, const int64_t* b, long n, int op) {
+	long i = 0;
+	switch (op) {
+		case LPACK_ADD:
+			VI_LOOP(VI_ADD);
+			for (; i < n; i++) { r[i] = (int64_t)((uint64_t)a[i] + (uint64_t)b[i]); }
+		break;
+		case LPACK_SUB:
+			VI_LOOP(VI_SUB);
+			for (; i < n; i++) { r[i] = (int64_t)((uint64_t)a[i] - (uint64_t)b[i]); }
+		break;
+		case LPACK_MUL:
+			for (; i < n; i++) { r[i] = (int64_t)((uint64_t)a[i] * (uint64_t)b[i]); }
+		break;
+		case LPACK_DIV:
+			for (; i < n; i++) { r[i] = b[i] == -1 ? (int64_t)(0 - (uint64_t)a[i]) : a[i] / b[i]; }
+		break;
+	}
+}
+
+void lpack_arith(lpack* r, lpack* a, lpack* b, int op) {
+	if (a->kind == LPACK_DBL) {
+		lpack_arith_dbl(r->data, a->data, b->data, a->count, op);
+	} else {
+		lpack_arith_int(r->data, a->data, b->data, a->count, op);
+	}
+}
+
+static void lpack_cmp_dbl(int64_t* r, const double* a, const double* b, long n, int op) {
+	long i = 0;
+	switch (op) {
+		case LPACK_GT: VD_CMP_LOOP(VD_GT); for (; i < n; i++) { r[i] = a[i] > b[i]; } break;
+		case LPACK_LT: VD_CMP_LOOP(VD_LT); for (; i < n; i++) { r[i] = a[i] < b[i]; } break;
+		case LPACK_GE: VD_CMP_LOOP(VD_GE); for (; i < n; i++) { r[i] = a[i] >= b[i]; } break;
+		case LPACK_LE: VD_CMP_LOOP(VD_LE); for (; i < n; i++) { r[i] = a[i] <= b[i]; } break;
+		case LPACK_EQ: VD_CMP_LOOP(VD_EQ); for (; i < n; i++) { r[i] = a[i] == b[i]; } break;
+	}
+}
+
+/* Only a greater than and an equal compare exist, the rest are made */
+/* by swapping the operands or negating the result                  */
+static void lpack_cmp_int(int64_t* r, const int64_t* a, const int64_t* b, long n, int op) {
+	long i = 0;
+#ifdef VI_GT
+	for (; i + VI_LANES <= n; i += VI_LANES) {
+		VI x = VI_LOAD(a + i);
+		VI y = VI_LOAD(b + i);
+		VI v;
+		switch (op) {
+			case LPACK_GT: v = VI_AND(VI_GT(x, y), VI_ONES); break;
+			case LPACK_LT: v = VI_AND(VI_GT(y, x), VI_ONES); break;
+			case LPACK_GE: v = VI_ANDNOT(VI_GT(y, x), VI_ONES); break;
+			case LPACK_LE: v = VI_ANDNOT(VI_GT(x, y), VI_ONES); break;
+			default:       v = VI_AND(VI_EQ(x, y), VI_ONES); break;
+		}
+		VI_STORE(r + i, v);
+	}
+#endif
+	switch (op) {
+		case LPACK_GT: for (; i < n; i++) { r[i] = a[i] > b[i]; } break;
+		case LPACK_LT: for (; i < n; i++) { r[i] = a[i] < b[i]; } break;
+		case LPACK_GE: for (; i < n; i++) { r[i] = a[i] >= b[i]; } break;
+		case LPACK_LE: for (; i < n; i++) { r[i] = a[i] <= b[i]; } break;
+		case LPACK_EQ: for (; i < n; i++) { r[i] = a[i] == b[i]; } break;
+	}
+}
+
+void lpack_cmp(lpack* r, lpack* a, lpack* b, int op) {
+	if (a->kind == LPACK_DBL) {
+		lpack_cmp_dbl(r->data, a->data, b->data, a->count, op);
+	} else {
+		lpack_cmp_int(r->data, a->data, b->data, a->count, op);
+	}
+}
+
+int lpack_has_zero(lpack* p) {
+	for (long i = 0; i < p->count; i++) {
+		if (p->kind == LPACK_DBL ? ((double*)p->data)[i] == 0 : ((int64_t*)p->data)[i] == 0) { return 1; }
+	}
+	return 0;
+}
+
+/*===================================== Reductions =====================================*/
+
+lpack_num lpack_sum(lpack* p) {
+	lpack_num x;
+	long n = p->count;
+	long i = 0;
+
+	if (p->kind == LPACK_DBL) {
+		const double* a = p->data;
+		double s = 0;
+#ifdef VD
+		double lanes[VD_LANES];
+		VD acc = VD_ZERO();
+		for (; i + VD_LANES <= n; i += VD_LANES) { acc = VD_ADD(acc, VD_LOAD(a + i)); }
+		VD_STORE(lanes, acc);
+		for (int j = 0; j < VD_LANES; j++) { s += lanes[j]; }
+#endif
+		for (; i < n; i++) { s += a[i]; }
+		x.d = s;
+	} else {
+		const int64_t* a = p->data;
+		uint64_t s = 0;
+#ifdef VI
+		uint64_t lanes[VI_LANES];
+		VI acc = VI_ZERO();
+		for (; i + VI_LANES <= n; i += VI_LANES) { acc = VI_ADD(acc, VI_LOAD(a + i)); }
+		VI_STORE(lanes, acc);
+		for (int j = 0; j < VI_LANES; j++) { s += lanes[j]; }
+#endif
+		for (; i < n; i++) { s += (uint64_t)a[i]; }
+		x.i = (int64_t)s;
+	}
+	return x;
+}
+
+lpack_num lpack_dot(lpack* p, lpack* q) {
+	lpack_num x;
+	long n = p->count;
+	long i = 0;
+
+	if (p->kind == LPACK_DBL) {
+		const double* a = p->data;
+		const double* b = q->data;
+		double s = 0;
+#ifdef VD
+		double lanes[VD_LANES];
+		VD acc = VD_ZERO();
+		for (; i + VD_LANES <= n; i += VD_LANES) { acc = VD_ADD(acc, VD_MUL(VD_LOAD(a + i), VD_LOAD(b + i))); }
+		VD_STORE(lanes, acc);
+		for (int j = 0; j < VD_LANES; j++) { s += lanes[j]; }
+#endif
+		for (; i < n; i++) { s += a[i] * b[i]; }
+		x.d = s;
+	} else {
+		const int64_t* a = p->data;
+		const int64_t* b = q->data;
+		uint64_t s = 0;
+		for (; i < n; i++) { s += (uint64_t)a[i] * (uint64_t)b[i]; }
+		x.i = (int64_t)s;
+	}
+	return x;
+}
+
+/* Whether 'y' replaces 'm' as the minimum, or with 'max' set the */
+/* maximum. A nan always does and is never replaced, so a nan     */
+/* anywhere makes the result nan.                                 */
+static inline int lpack_dbl_beats(double y, double m, int max) {
+	return y != y || (max ? y > m : y < m);
+}
+
+/* The minimum, or with 'max' set the maximum */
+static lpack_num lpack_extreme(lpack* p, int max) {
+	lpack_num x;
+	long n = p->count;
+	long i = 1;
+
+	if (p->kind == LPACK_DBL) {
+		const double* a = p->data;
+		double m = a[0];
+#ifdef VD
+		/* The min and max instructions give their second operand when */
+		/* either is nan, so nans are looked for separately            */
+		if (n >= VD_LANES) {
+			double lanes[VD_LANES];
+			VD acc = VD_LOAD(a);
+			VD nan = VD_UNORD(acc, acc);
+			for (i = VD_LANES; i + VD_LANES <= n; i += VD_LANES) {
+				VD v = VD_LOAD(a + i);
+				nan = VD_OR(nan, VD_UNORD(v, v));
+				acc = max ? VD_MAX(acc, v) : VD_MIN(acc, v);
+			}
+			VD_STORE(lanes, acc);
+			for (int j = 0; j < VD_LANES; j++) { m = lpack_dbl_beats(lanes[j], m, max) ? lanes[j] : m; }
+			if (VD_MASK(nan) != 0) { m = NAN; }
+		}
+#endif
+		for (; i < n; i++) { m = lpack_dbl_beats(a[i], m, max) ? a[i] : m; }
+		x.d = m;
+	} else {
+		const int64_t* a = p->data;
+		int64_t m = a[0];
+		for (; i < n; i++) { m = (max ? a[i] > m : a[i] < m) ? a[i] : m; }
+		x.i = m;
+	}
+	return x;
+}
+
+lpack_num lpack_min(lpack* p) {
+	return lpack_extreme(p, 0);
+}
+
+lpack_num lpack_max(lpack* p) {
+	return lpack_extreme(p, 1);
+}
@@ -0,0 +1,55 @@
+#ifndef LPACK_HEADER
+#define LPACK_HEADER
+
+// Standard Include
+#include <stdint.h>
+
+/*===================================== Struct Definition =====================================*/
+
+/* Kinds of element a packed vector holds */
+enum { LPACK_INT, LPACK_DBL };
+
+/* A packed vector, 'count' int64_t or double elements stored one after */
+/* another in 'data', rather than as a list of separate Number lvals.   */
+/* Ints wrap around on overflow rather than becoming Bignums.          */
+typedef struct lpack {
+	int kind;
+	long count;
+	void* data;
+} lpack;
+
+/* A sum, dot product, minimum or maximum, of the kind of its vector */
+typedef union lpack_num {
+	int64_t i;
+	double d;
+} lpack_num;
+
+/* Element-wise operations */
+enum { LPACK_ADD, LPACK_SUB, LPACK_MUL, LPACK_DIV };
+enum { LPACK_GT, LPACK_LT, LPACK_GE, LPACK_LE, LPACK_EQ };
+
+/*===================================== Declared Functions =====================================*/
+
+/* A vector of 'count' elements of 'kind', their values unset */
+void lpack_alloc(lpack* p, int kind, long count);
+void lpack_copy(lpack* r, lpack* a);
+void lpack_free(lpack* p);
+
+/* Element-wise 'op' of 'a' and 'b', vectors of the same kind and count, */
+/* into 'r', allocated by the caller. 'r' may be 'a' or 'b'. Int         */
+/* division by zero must be checked for first, see lpack_has_zero.      */
+/* Comparisons give ints of 1 or 0.                                    */
+void lpack_arith(lpack* r, lpack* a, lpack* b, int op);
+void lpack_cmp(lpack* r, lpack* a, lpack* b, int op);
+int lpack_has_zero(lpack* p);
+
+/* Reductions. The minimum and maximum need at least one element, */
+/* and are nan when any element is. Doubles are summed in several  */
+/* lanes at once, so the rounding may differ from a sum taken in   */
+/* order.                                                          */
+lpack_num lpack_sum(lpack* a);
+lpack_num lpack_dot(lpack* a, lpack* b);
+lpack_num lpack_min(lpack* a);
+lpack_num lpack_max(lpack* a);
+
+#endif
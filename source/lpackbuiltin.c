@@ -0,0 +1,221 @@
+/*========================================= Includes =========================================*/
+
+// Standard Include
+#include <stdint.h>
+
+// Local Include
+#include "lisputils.h"
+#include "lenviron.h"
+#include "lvalue.h"
+#include "lpack.h"
+#include "builtin.h"
+
+// Header Include
+#include "lpackbuiltin.h"
+
+/*===================================== Defined Functions =====================================*/
+
+/* Operator names, for error messages, indexed by the ops of lpack.h */
+static char* vop_names[] = { "v+", "v-", "v*", "v/" };
+static char* vcmp_names[] = { "v>", "v<", "v>=", "v<=", "v==" };
+
+lval* builtin_ivec(lenv* e, lval* a) {
+	LASSERT_NUM("ivec", a, 1);
+	LASSERT_TYPE("ivec", a, 0, LVAL_QEXPR);
+
+	lval* l = a->cell[0];
+	for (int i = 0; i < l->count; i++) {
+		LASSERT(a, l->cell[i]->type == LVAL_NUM,
+			"Function 'ivec' passed incorrect type for item %d. Got %s, Expected %s.",
+			i, ltype_name(l->cell[i]->type), ltype_name(LVAL_NUM));
+	}
+
+	lpack p;
+	lpack_alloc(&p, LPACK_INT, l->count);
+	for (int i = 0; i < l->count; i++) { ((int64_t*)p.data)[i] = l->cell[i]->num; }
+	lval_del(a);
+	return lval_pack(&p);
+}
+
+lval* builtin_dvec(lenv* e, lval* a) {
+	LASSERT_NUM("dvec", a, 1);
+	LASSERT_TYPE("dvec", a, 0, LVAL_QEXPR);
+
+	lval* l = a->cell[0];
+	for (int i = 0; i < l->count; i++) {
+		LASSERT(a, builtin_is_num(l->cell[i]),
+			"Function 'dvec' passed incorrect type for item %d. Got %s, Expected %s.",
+			i, ltype_name(l->cell[i]->type), ltype_name(LVAL_NUM));
+	}
+
+	lpack p;
+	lpack_alloc(&p, LPACK_DBL, l->count);
+	for (int i = 0; i < l->count; i++) { ((double*)p.data)[i] = builtin_dbl(l->cell[i]); }
+	lval_del(a);
+	return lval_pack(&p);
+}
+
+/* An element, sum, dot product, minimum or maximum as a Number or Double */
+static lval* builtin_pack_num(int kind, lpack_num x) {
+	return kind == LPACK_DBL ? lval_dbl(x.d) : lval_num((long)x.i);
+}
+
+lval* builtin_vlist(lenv* e, lval* a) {
+	LASSERT_NUM("vlist", a, 1);
+	LASSERT_TYPE("vlist", a, 0, LVAL_PACK);
+
+	lpack* p = &a->cell[0]->pack;
+	lval* l = lval_qexpr();
+	for (long i = 0; i < p->count; i++) {
+		lpack_num x;
+		if (p->kind == LPACK_DBL) { x.d = ((double*)p->data)[i]; } else { x.i = ((int64_t*)p->data)[i]; }
+		l = lval_add(l, builtin_pack_num(p->kind, x));
+	}
+	lval_del(a);
+	return l;
+}
+
+lval* builtin_vlen(lenv* e, lval* a) {
+	LASSERT_NUM("vlen", a, 1);
+	LASSERT_TYPE("vlen", a, 0, LVAL_PACK);
+
+	lval* x = lval_num(a->cell[0]->pack.count);
+	lval_del(a);
+	return x;
+}
+
+/* Assert two vectors of one kind and length, for element-wise 'func' */
+#define LASSERT_PACKS(func, args) \
+	LASSERT_NUM(func, args, 2); \
+	LASSERT_TYPE(func, args, 0, LVAL_PACK); \
+	LASSERT_TYPE(func, args, 1, LVAL_PACK); \
+	LASSERT(args, args->cell[0]->pack.kind == args->cell[1]->pack.kind \
+		&& args->cell[0]->pack.count == args->cell[1]->pack.count, \
+		"Function '%s' passed vectors of different kinds or lengths.", func);
+
+/* A vector for the result of an element-wise operation on 'a', being */
+/* its first argument itself when nothing else holds it              */
+static lval* builtin_vresult(lval* a, int kind) {
+	lval* x = a->cell[0];
+	if (x->ref == 1 && x->pack.kind == kind) { return lval_copy(x); }
+
+	lpack p;
+	lpack_alloc(&p, kind, x->pack.count);
+	return lval_pack(&p);
+}
+
+/* Int division by zero is an error, double division gives infinities */
+/* and nans, as doubles are expected to                                */
+static inline lval* builtin_vop(lenv* e, lval* a, int op) {
+	LASSERT_PACKS(vop_names[op], a);
+	LASSERT(a, op != LPACK_DIV || a->cell[1]->pack.kind == LPACK_DBL || !lpack_has_zero(&a->cell[1]->pack),
+		"Division by Zero!");
+
+	lval* r = builtin_vresult(a, a->cell[0]->pack.kind);
+	lpack_arith(&r->pack, &a->cell[0]->pack, &a->cell[1]->pack, op);
+	lval_del(a);
+	return r;
+}
+
+lval* builtin_vadd(lenv* e, lval* a) {
+	return builtin_vop(e, a, LPACK_ADD);
+}
+
+lval* builtin_vsub(lenv* e, lval* a) {
+	return builtin_vop(e, a, LPACK_SUB);
+}
+
+lval* builtin_vmul(lenv* e, lval* a) {
+	return builtin_vop(e, a, LPACK_MUL);
+}
+
+lval* builtin_vdiv(lenv* e, lval* a) {
+	return builtin_vop(e, a, LPACK_DIV);
+}
+
+/* Comparisons give an int vector of 1 where true and 0 where not */
+static inline lval* builtin_vcmp(lenv* e, lval* a, int op) {
+	LASSERT_PACKS(vcmp_names[op], a);
+
+	lval* r = builtin_vresult(a, LPACK_INT);
+	lpack_cmp(&r->pack, &a->cell[0]->pack, &a->cell[1]->pack, op);
+	lval_del(a);
+	return r;
+}
+
+lval* builtin_vgt(lenv* e, lval* a) {
+	return builtin_vcmp(e, a, LPACK_GT);
+}
+
+lval* builtin_vlt(lenv* e, lval* a) {
+	return builtin_vcmp(e, a, LPACK_LT);
+}
+
+lval* builtin_vge(lenv* e, lval* a) {
+	return builtin_vcmp(e, a, LPACK_GE);
+}
+
+lval* builtin_vle(lenv* e, lval* a) {
+	return builtin_vcmp(e, a, LPACK_LE);
+}
+
+lval* builtin_veq(lenv* e, lval* a) {
+	return builtin_vcmp(e, a, LPACK_EQ);
+}
+
+lval* builtin_vdot(lenv* e, lval* a) {
+	LASSERT_PACKS("vdot", a);
+
+	lval* x = builtin_pack_num(a->cell[0]->pack.kind, lpack_dot(&a->cell[0]->pack, &a->cell[1]->pack));
+	lval_del(a);
+	return x;
+}
+
+lval* builtin_vsum(lenv* e, lval* a) {
+	LASSERT_NUM("vsum", a, 1);
+	LASSERT_TYPE("vsum", a, 0, LVAL_PACK);
+
+	lval* x = builtin_pack_num(a->cell[0]->pack.kind, lpack_sum(&a->cell[0]->pack));
+	lval_del(a);
+	return x;
+}
+
+lval* builtin_vmin(lenv* e, lval* a) {
+	LASSERT_NUM("vmin", a, 1);
+	LASSERT_TYPE("vmin", a, 0, LVAL_PACK);
+	LASSERT(a, a->cell[0]->pack.count > 0, "Function 'vmin' passed an empty vector.");
+
+	lval* x = builtin_pack_num(a->cell[0]->pack.kind, lpack_min(&a->cell[0]->pack));
+	lval_del(a);
+	return x;
+}
+
+lval* builtin_vmax(lenv* e, lval* a) {
+	LASSERT_NUM("vmax", a, 1);
+	LASSERT_TYPE("vmax", a, 0, LVAL_PACK);
+	LASSERT(a, a->cell[0]->pack.count > 0, "Function 'vmax' passed an empty vector.");
+
+	lval* x = builtin_pack_num(a->cell[0]->pack.kind, lpack_max(&a->cell[0]->pack));
+	lval_del(a);
+	return x;
+}
+
+void lpack_add_builtins(lenv* e) {
+	lenv_add_builtin(e, "ivec",  builtin_ivec);
+	lenv_add_builtin(e, "dvec",  builtin_dvec);
+	lenv_add_builtin(e, "vlist", builtin_vlist);
+	lenv_add_builtin(e, "vlen",  builtin_vlen);
+	lenv_add_builtin(e, "v+",    builtin_vadd);
+	lenv_add_builtin(e, "v-",    builtin_vsub);
+	lenv_add_builtin(e, "v*",    builtin_vmul);
+	lenv_add_builtin(e, "v/",    builtin_vdiv);
+	lenv_add_builtin(e, "v>",    builtin_vgt);
+	lenv_add_builtin(e, "v<",    builtin_vlt);
+	lenv_add_builtin(e, "v>=",   builtin_vge);
+	lenv_add_builtin(e, "v<=",   builtin_vle);
+	lenv_add_builtin(e, "v==",   builtin_veq);
+	lenv_add_builtin(e, "vdot",  builtin_vdot);
+	lenv_add_builtin(e, "vsum",  builtin_vsum);
+	lenv_add_builtin(e, "vmin",  builtin_vmin);
+	lenv_add_builtin(e, "vmax",  builtin_vmax);
+}
@@ -0,0 +1,34 @@
+#ifndef LPACKBUILTIN_HEADER
+#define LPACKBUILTIN_HEADER
+
+/* Forward declare dependencies */
+struct lenv;
+struct lval;
+typedef struct lenv lenv;
+typedef struct lval lval;
+
+/*===================================== Declared Functions =====================================*/
+
+/* Packed vectors, see lpack.h */
+lval* builtin_ivec(lenv* e, lval* a);
+lval* builtin_dvec(lenv* e, lval* a);
+lval* builtin_vlist(lenv* e, lval* a);
+lval* builtin_vlen(lenv* e, lval* a);
+lval* builtin_vadd(lenv* e, lval* a);
+lval* builtin_vsub(lenv* e, lval* a);
+lval* builtin_vmul(lenv* e, lval* a);
+lval* builtin_vdiv(lenv* e, lval* a);
+lval* builtin_vgt(lenv* e, lval* a);
+lval* builtin_vlt(lenv* e, lval* a);
+lval* builtin_vge(lenv* e, lval* a);
+lval* builtin_vle(lenv* e, lval* a);
+lval* builtin_veq(lenv* e, lval* a);
+lval* builtin_vdot(lenv* e, lval* a);
+lval* builtin_vsum(lenv* e, lval* a);
+lval* builtin_vmin(lenv* e, lval* a);
+lval* builtin_vmax(lenv* e, lval* a);
+
+/* Add the builtins above to 'e' */
+void lpack_add_builtins(lenv* e);
+
+#endif
@@ -0,0 +1,271 @@
+/*========================================= Includes =========================================*/
+
+// Standard Include
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Local Include
+#include "lvalue.h"
+#include "lalloc.h"
+
+// Header Include
+#include "lprof.h"
+
+/*===================================== Struct Definitions =====================================*/
+
+/* Totals for one function */
+typedef struct lprof_fn {
+	void* key;
+	lval* held; /* Referenced so the key is not freed and reused */
+	char* name;
+	unsigned long calls;
+	long long total_ns;
+	long long self_ns;
+	unsigned long allocs;
+	int active; /* Calls of it in progress, so recursion is timed once */
+} lprof_fn;
+
+/* A node of the call tree, one for every distinct stack of calls */
+typedef struct lprof_node {
+	lprof_fn* fn;
+	struct lprof_node* parent;
+	struct lprof_node* child;
+	struct lprof_node* sibling;
+	struct lprof_node* all; /* Every node, to free them */
+	long long self_ns;
+} lprof_node;
+
+/* A call in progress */
+typedef struct lprof_frame {
+	lprof_node* node;
+	long long start_ns;
+	long long child_ns;
+	unsigned long start_allocs;
+	unsigned long child_allocs;
+} lprof_frame;
+
+/*===================================== Profiler State =====================================*/
+
+int lprof_enabled = 0;
+char* lprof_stacks = NULL;
+
+/* Functions by key, an open-addressing table, and in order of creation */
+static lprof_fn** table = NULL;
+static int table_cap = 0;
+static lprof_fn** fns = NULL;
+static int fns_count = 0;
+
+/* Root of the call tree and the calls in progress */
+static lprof_node root = { NULL, NULL, NULL, NULL, NULL, 0 };
+static lprof_node* nodes = NULL;
+static lprof_frame* frames = NULL;
+static int frames_count = 0;
+static int frames_cap = 0;
+
+static long long lprof_now(void) {
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/*===================================== Function Table =====================================*/
+
+static int lprof_slot(lprof_fn** t, int cap, void* key) {
+	int i = (int)(((unsigned long)key >> 4) & (cap - 1));
+	while (t[i] != NULL && t[i]->key != key) { i = (i + 1) & (cap - 1); }
+	return i;
+}
+
+/* The entry for 'f', created the first time it is seen */
+static lprof_fn* lprof_fn_get(lval* f) {
+	lval* held = f->builtin != NULL ? f : f->body;
+
+	if (table_cap > 0) {
+		lprof_fn* fn = table[lprof_slot(table, table_cap, held)];
+		if (fn != NULL) { return fn; }
+	}
+
+	/* Keep the load factor at or below 1/2 */
+	if ((fns_count + 1) * 2 > table_cap) {
+		int cap = table_cap ? table_cap * 2 : 64;
+		lprof_fn** t = calloc(cap, sizeof(lprof_fn*));
+		for (int i = 0; i < fns_count; i++) {
+			t[lprof_slot(t, cap, fns[i]->key)] = fns[i];
+		}
+		free(table);
+		table = t;
+		table_cap = cap;
+		fns = realloc(fns, sizeof(lprof_fn*) * cap);
+	}
+
+	lprof_fn* fn = calloc(1, sizeof(lprof_fn));
+	fn->key = held;
+	fn->held = lval_copy(held);
+	table[lprof_slot(table, table_cap, held)] = fn;
+	fns[fns_count++] = fn;
+	return fn;
+}
+
+void lprof_name(lval* f, char* name) {
+	lprof_fn* fn = lprof_fn_get(f);
+	if (fn->name == NULL) { fn->name = name; }
+}
+
+/*===================================== Call Tracking =====================================*/
+
+void lprof_enter(lval* f) {
+	lprof_fn* fn = lprof_fn_get(f);
+	fn->active++;
+
+	/* Find this function among the children of the current call */
+	lprof_node* parent = frames_count ? frames[frames_count - 1].node : &root;
+	lprof_node* node = parent->child;
+	while (node != NULL && node->fn != fn) { node = node->sibling; }
+	if (node == NULL) {
+		node = calloc(1, sizeof(lprof_node));
+		node->fn = fn;
+		node->parent = parent;
+		node->sibling = parent->child;
+		parent->child = node;
+		node->all = nodes;
+		nodes = node;
+	}
+
+	if (frames_count == frames_cap) {
+		frames_cap = frames_cap ? frames_cap * 2 : 64;
+		frames = realloc(frames, sizeof(lprof_frame) * frames_cap);
+	}
+	lprof_frame* fr = &frames[frames_count++];
+	fr->node = node;
+	fr->child_ns = 0;
+	fr->child_allocs = 0;
+	fr->start_allocs = lalloc_stats.lval_allocs;
+	fr->start_ns = lprof_now();
+}
+
+void lprof_exit(void) {
+	long long now = lprof_now();
+	lprof_frame* fr = &frames[--frames_count];
+	lprof_fn* fn = fr->node->fn;
+
+	long long elapsed = now - fr->start_ns;
+	unsigned long allocs = lalloc_stats.lval_allocs - fr->start_allocs;
+
+	fn->calls++;
+	fn->self_ns += elapsed - fr->child_ns;
+	fn->allocs += allocs - fr->child_allocs;
+	fr->node->self_ns += elapsed - fr->child_ns;
+
+	/* Only the outermost of recursive calls adds to the total */
+	if (--fn->active == 0) { fn->total_ns += elapsed; }
+
+	if (frames_count > 0) {
+		frames[frames_count - 1].child_ns += elapsed;
+		frames[frames_count - 1].child_allocs += allocs;
+	}
+}
+
+/*===================================== Report =====================================*/
+
+static char* lprof_fn_name(lprof_fn* fn) {
+	return fn->name != NULL ? fn->name : "<lambda>";
+}
+
+/* Most time spent in the function itself first */
+static int lprof_cmp(const void* a, const void* b) {
+	lprof_fn* x = *(lprof_fn**)a;
+	lprof_fn* y = *(lprof_fn**)b;
+	if (x->self_ns != y->self_ns) { return x->self_ns < y->self_ns ? 1 : -1; }
+	if (x->calls != y->calls) { return x->calls < y->calls ? 1 : -1; }
+	return 0;
+}
+
+/* Write a line "outer;...;inner microseconds" for each node of the */
+/* call tree, walking it without recursion as it may be very deep.   */
+static void lprof_write_stacks(FILE* out) {
+	size_t len = 0;
+	size_t path_cap = 256;
+	char* path = malloc(path_cap);
+	size_t* starts = NULL;
+	int depth = 0;
+	int starts_cap = 0;
+
+	lprof_node* n = root.child;
+	while (n != NULL) {
+		/* Append this node's name to the path */
+		char* name = lprof_fn_name(n->fn);
+		size_t need = len + strlen(name) + 2;
+		if (need > path_cap) {
+			while (need > path_cap) { path_cap *= 2; }
+			path = realloc(path, path_cap);
+		}
+		if (depth == starts_cap) {
+			starts_cap = starts_cap ? starts_cap * 2 : 64;
+			starts = realloc(starts, sizeof(size_t) * starts_cap);
+		}
+		starts[depth++] = len;
+		len += sprintf(path + len, "%s%s", len ? ";" : "", name);
+
+		long long us = n->self_ns / 1000;
+		if (us > 0) { fprintf(out, "%s %lld\n", path, us); }
+
+		if (n->child != NULL) { n = n->child; continue; }
+
+		/* Leave nodes until one has a sibling to visit */
+		for (;;) {
+			len = starts[--depth];
+			path[len] = '\0';
+			if (n->sibling != NULL) { n = n->sibling; break; }
+			n = n->parent;
+			if (n == &root) { n = NULL; break; }
+		}
+	}
+
+	free(starts);
+	free(path);
+}
+
+void lprof_report(void) {
+	qsort(fns, fns_count, sizeof(lprof_fn*), lprof_cmp);
+
+	fprintf(stderr, "%12s %12s %12s %12s  %s\n",
+		"calls", "total ms", "self ms", "allocs", "function");
+	for (int i = 0; i < fns_count; i++) {
+		lprof_fn* fn = fns[i];
+		if (fn->calls == 0) { continue; }
+		fprintf(stderr, "%12lu %12.3f %12.3f %12lu  %s\n",
+			fn->calls, fn->total_ns / 1e6, fn->self_ns / 1e6,
+			fn->allocs, lprof_fn_name(fn));
+	}
+
+	if (lprof_stacks != NULL) {
+		FILE* out = fopen(lprof_stacks, "w");
+		if (out == NULL) {
+			fprintf(stderr, "Could not open '%s'\n", lprof_stacks);
+		} else {
+			lprof_write_stacks(out);
+			fclose(out);
+		}
+	}
+
+	/* Free everything */
+	while (nodes != NULL) {
+		lprof_node* next = nodes->all;
+		free(nodes);
+		nodes = next;
+	}
+	root.child = NULL;
+	for (int i = 0; i < fns_count; i++) {
+		lval_del(fns[i]->held);
+		free(fns[i]);
+	}
+	free(fns);
+	free(table);
+	free(frames);
+	fns = NULL;
+	table = NULL;
+	frames = NULL;
+	fns_count = table_cap = frames_count = frames_cap = 0;
+}
@@ -0,0 +1,31 @@
+#ifndef LPROF_HEADER
+#define LPROF_HEADER
+
+/* Forward declare dependencies */
+struct lval;
+typedef struct lval lval;
+
+/*===================================== Profiler Selection =====================================*/
+
+/* Calls are profiled when set, by --profile or --profile=FILE. FILE is */
+/* where the call stacks are written in the collapsed format taken by  */
+/* flamegraph.pl, NULL if they are not wanted.                         */
+extern int lprof_enabled;
+extern char* lprof_stacks;
+
+/*===================================== Declared Functions =====================================*/
+
+/* Functions are told apart by identity: a builtin by its lval, a lambda */
+/* by its body, which copies and partial applications share. Each is    */
+/* named after the first global symbol it is bound to.                  */
+void lprof_name(lval* f, char* name);
+
+/* Bracket a call of 'f', including the calls it makes. A call left to */
+/* lval_apply from tail position ends its caller's, as its frame does. */
+void lprof_enter(lval* f);
+void lprof_exit(void);
+
+/* Print the report to stderr, write the stacks file and free it all */
+void lprof_report(void);
+
+#endif
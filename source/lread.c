@@ -0,0 +1,351 @@
+/*========================================= Includes =========================================*/
+
+// Standard Include
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Local Include
+#include "lisputils.h"
+#include "lvalue.h"
+
+// Header Include
+#include "lread.h"
+
+/*===================================== Reader Selection =====================================*/
+
+int lread_enabled = 1;
+
+/*===================================== Character Classes =====================================*/
+
+static int lread_is_space(char c) {
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+static int lread_is_digit(char c) {
+	return c >= '0' && c <= '9';
+}
+
+/* Characters of the grammar's symbol regex, [a-zA-Z0-9_+\-*\/\\=<>!&^%] */
+static int lread_is_symbol(char c) {
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || lread_is_digit(c)
+		|| (c != '\0' && strchr("_+-*/\\=<>!&^%", c) != NULL);
+}
+
+/*===================================== Atom Readers =====================================*/
+
+/* The character 'c' as mpc names it in errors, quoted in 'buf' if it is */
+/* not one of those it spells out                                       */
+static char* lread_char_name(char c, char buf[4]) {
+	switch (c) {
+		case '\a': return "bell";
+		case '\b': return "backspace";
+		case '\f': return "formfeed";
+		case '\r': return "carriage return";
+		case '\v': return "vertical tab";
+		case '\0': return "end of input";
+		case '\n': return "newline";
+		case '\t': return "tab";
+		case ' ' : return "space";
+	}
+	buf[0] = '\'';
+	buf[1] = c;
+	buf[2] = '\'';
+	buf[3] = '\0';
+	return buf;
+}
+
+/* An error at offset 'at', formatted as mpc formats its errors. Rows and */
+/* columns are only counted once reading has failed.                      */
+static lval* lread_error(char* filename, char* src, long len, long at, char* expected) {
+	long row = 1;
+	long col = 1;
+	for (long i = 0; i < at; i++) {
+		if (src[i] == '\n') { row++; col = 1; } else { col++; }
+	}
+
+	if (at >= len) {
+		return lval_err("%s:%ld:%ld: error: expected %s at end of input\n",
+			filename, row, col, expected);
+	}
+	char buf[4];
+	return lval_err("%s:%ld:%ld: error: expected %s at %s\n",
+		filename, row, col, expected, lread_char_name(src[at], buf));
+}
+
+static lval* lread_bignum(char* src, long n) {
+	lbig b;
+	lbig_parse(&b, src, n);
+	return lval_bignum(&b);
+}
+
+/* Read the number of digits, with an optional leading '-', at 'src'. */
+/* Accumulated as a negative value so LONG_MIN can be read too, and  */
+/* read again as a Bignum if it will not fit.                        */
+static lval* lread_num(char* src, long n) {
+	int neg = src[0] == '-';
+	long x = 0;
+	for (long i = neg; i < n; i++) {
+		int d = src[i] - '0';
+		if (x < (LONG_MIN + d) / 10) { return lread_bignum(src, n); }
+		x = x * 10 - d;
+	}
+	if (!neg) {
+		if (x == LONG_MIN) { return lread_bignum(src, n); }
+		x = -x;
+	}
+	return lval_num(x);
+}
+
+/* Read the Double of 'n' characters at 'src', already checked */
+static lval* lread_dbl(char* src, long n) {
+	char buffer[64];
+	char* s = n < (long)sizeof(buffer) ? buffer : malloc(n + 1);
+	memcpy(s, src, n);
+	s[n] = '\0';
+	lval* x = lval_dbl(strtod(s, NULL));
+	if (s != buffer) { free(s); }
+	return x;
+}
+
+/* How many of the 'n' characters at 'src' match the spelling of an  */
+/* infinity or nan as lval_print_dbl prints them, [-+]inf.0 or      */
+/* [-+]nan.0, so 6 when the whole of one is there                   */
+static int lread_dbl_word(char* src, long n) {
+	if (n < 1 || (src[0] != '-' && src[0] != '+')) { return 0; }
+	char* word = n > 1 && src[1] == 'n' ? "nan.0" : "inf.0";
+	int i = 0;
+	while (i < 5 && i + 1 < n && src[i + 1] == word[i]) { i++; }
+	return i + 1;
+}
+
+static lval* lread_sym(char* src, long n) {
+	char buffer[64];
+	char* name = n < (long)sizeof(buffer) ? buffer : malloc(n + 1);
+	memcpy(name, src, n);
+	name[n] = '\0';
+
+	lval* x = lval_sym(name);
+	if (name != buffer) { free(name); }
+	return x;
+}
+
+/* Read the 'n' characters between a string's quotes, unescaping them as */
+/* mpcf_unescape does. An unknown escape is kept as it is and \0 dropped. */
+static lval* lread_str(char* src, long n) {
+	static const char escapes[] = "abfnrtv\\'\"0";
+	static const char values[]  = "\a\b\f\n\r\t\v\\'\"";
+
+	char* s = malloc(n + 1);
+	long j = 0;
+	for (long i = 0; i < n; i++) {
+		char* e = i + 1 < n && src[i] == '\\' ? strchr(escapes, src[i + 1]) : NULL;
+		if (e == NULL || *e == '\0') { s[j++] = src[i]; continue; }
+
+		if (*e != '0') { s[j++] = values[e - escapes]; }
+		i++;
+	}
+	s[j] = '\0';
+
+	lval* x = lval_str(s);
+	free(s);
+	return x;
+}
+
+/*===================================== Defined Functions =====================================*/
+
+lval* lread(char* filename, char* src, long len) {
+
+	/* Lists being read, innermost last. The outermost holds the result. */
+	int depth = 0;
+	int cap = 16;
+	lval** open = malloc(sizeof(lval*) * cap);
+	open[0] = lval_sexpr();
+
+	/* Where mpc's number regex would have failed after taking a '.' that */
+	/* no expression can start with. mpc reports the furthest place any  */
+	/* part of the grammar reached, so an error there is reported there. */
+	long far = 0;
+
+	lval* err = NULL;
+	long p = 0;
+	while (p < len) {
+		char c = src[p];
+
+		/* Whitespace and comments separate expressions */
+		if (lread_is_space(c)) { p++; continue; }
+		if (c == ';') {
+			while (p < len && src[p] != '\n' && src[p] != '\r') { p++; }
+			continue;
+		}
+
+		/* Open a new list */
+		if (c == '(' || c == '{') {
+			if (++depth == cap) {
+				cap *= 2;
+				open = realloc(open, sizeof(lval*) * cap);
+			}
+			open[depth] = c == '(' ? lval_sexpr() : lval_qexpr();
+			p++;
+			continue;
+		}
+
+		/* Close the innermost list, adding it to the one around it */
+		if (c == ')' || c == '}') {
+			char close = open[depth]->type == LVAL_SEXPR ? ')' : '}';
+			if (depth == 0 || c != close) { break; }
+			lval* x = open[depth--];
+			open[depth] = lval_add(open[depth], x);
+			p++;
+			continue;
+		}
+
+		/* Atoms, a number taking priority over a symbol as in the grammar */
+		long start = p;
+		lval* x;
+		if (c == '"') {
+			for (p++; p < len && src[p] != '"'; p++) {
+				if (src[p] == '\\') { p++; }
+			}
+			if (p >= len) {
+				err = lread_error(filename, src, len, len, "'\"'");
+				break;
+			}
+			x = lread_str(src + start + 1, p - start - 1);
+			p++;
+		} else if (lread_is_digit(c) || (c == '-' && p + 1 < len && lread_is_digit(src[p + 1]))) {
+			for (p++; p < len && lread_is_digit(src[p]); p++) {}
+
+			/* A fraction and an exponent make a Double */
+			int dbl = 0;
+			if (p + 1 < len && src[p] == '.' && lread_is_digit(src[p + 1])) {
+				for (p += 2; p < len && lread_is_digit(src[p]); p++) {}
+				dbl = 1;
+			} else if (p < len && src[p] == '.') {
+				far = p + 1;
+			}
+			if (p + 1 < len && (src[p] == 'e' || src[p] == 'E')) {
+				long q = p + 1 + (src[p + 1] == '-' || src[p + 1] == '+');
+				if (q < len && lread_is_digit(src[q])) {
+					for (p = q + 1; p < len && lread_is_digit(src[p]); p++) {}
+					dbl = 1;
+				}
+			}
+			x = dbl ? lread_dbl(src + start, p - start) : lread_num(src + start, p - start);
+		} else if (lread_dbl_word(src + p, len - p) == 6) {
+			p += 6;
+			x = lread_dbl(src + start, p - start);
+		} else if (lread_is_symbol(c)) {
+			for (p++; p < len && lread_is_symbol(src[p]); p++) {}
+			if (lread_dbl_word(src + start, len - start) == 5) { far = start + 5; }
+			x = lread_sym(src + start, p - start);
+		} else {
+			break;
+		}
+		open[depth] = lval_add(open[depth], x);
+	}
+
+	/* Stopped early, or ran out of input with a list still open */
+	if (err == NULL && (p < len || depth > 0)) {
+		char* expected = depth == 0 ? "expression or end of input"
+			: open[depth]->type == LVAL_SEXPR ? "expression or ')'" : "expression or '}'";
+		err = lread_error(filename, src, len, p > far ? p : far, expected);
+	}
+
+	if (err != NULL) {
+		for (int i = 0; i <= depth; i++) { lval_del(open[i]); }
+		free(open);
+		return err;
+	}
+
+	lval* x = open[0];
+	free(open);
+	return x;
+}
+
+int lread_open(char* filename, lsource* s) {
+	s->src = NULL;
+	s->len = 0;
+	s->mapped = 0;
+
+#ifndef _WIN32
+	/* A regular file is mapped, giving a view of it without copying */
+	int fd = open(filename, O_RDONLY);
+	if (fd < 0) { return 0; }
+
+	struct stat st;
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+		void* src = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (src != MAP_FAILED) {
+			close(fd);
+			s->src = src;
+			s->len = (long)st.st_size;
+			s->mapped = 1;
+			return 1;
+		}
+	}
+
+	/* Otherwise read the open descriptor in blocks, so pipes and the   */
+	/* like work too, as opening them again would wait for a new writer */
+	long cap = 1 << 16;
+	s->src = malloc(cap);
+	for (;;) {
+		ssize_t n = read(fd, s->src + s->len, cap - s->len);
+		if (n < 0 && errno == EINTR) { continue; }
+		if (n < 0) {
+			close(fd);
+			free(s->src);
+			s->src = NULL;
+			s->len = 0;
+			return 0;
+		}
+		if (n == 0) { break; }
+		s->len += (long)n;
+		if (s->len == cap) {
+			cap *= 2;
+			s->src = realloc(s->src, cap);
+		}
+	}
+	close(fd);
+	return 1;
+#else
+	/* Read in blocks */
+	FILE* f = fopen(filename, "rb");
+	if (f == NULL) { return 0; }
+
+	long cap = 1 << 16;
+	s->src = malloc(cap);
+	for (;;) {
+		s->len += (long)fread(s->src + s->len, 1, cap - s->len, f);
+		if (s->len < cap) { break; }
+		cap *= 2;
+		s->src = realloc(s->src, cap);
+	}
+	fclose(f);
+	return 1;
+#endif
+}
+
+void lread_close(lsource* s) {
+#ifndef _WIN32
+	if (s->mapped) { munmap(s->src, s->len); return; }
+#endif
+	free(s->src);
+}
+
+lval* lread_file(char* filename) {
+	lsource s;
+	if (!lread_open(filename, &s)) { return lval_err("%s: error: Unable to open file!\n", filename); }
+
+	lval* x = lread(filename, s.src, s.len);
+	lread_close(&s);
+	return x;
+}
@@ -0,0 +1,41 @@
+#ifndef LREAD_HEADER
+#define LREAD_HEADER
+
+/* Forward declare dependencies */
+struct lval;
+typedef struct lval lval;
+
+/*===================================== Struct Definitions =====================================*/
+
+/* The bytes of a source file, which need not end in '\0' */
+typedef struct lsource {
+	char* src;
+	long len;
+	int mapped;
+} lsource;
+
+/*===================================== Reader Selection =====================================*/
+
+/* Source is read by the reader here when set, otherwise by the mpc */
+/* grammar in parse.c and lval_read. Set by --reader=fast|mpc, on by */
+/* default.                                                          */
+extern int lread_enabled;
+
+/*===================================== Declared Functions =====================================*/
+
+/* The reader takes the same syntax as the mpc grammar in a single pass */
+/* over the bytes, without backtracking or building a syntax tree. It   */
+/* returns every expression read in an S-expression, or an error giving */
+/* the row and column in 'filename' where reading failed, as mpc does.  */
+lval* lread(char* filename, char* src, long len);
+
+/* Open file 'filename' for reading into 's', returning 0 if it cannot */
+/* be opened. A regular file is mapped into memory, anything else, like */
+/* a pipe, is read into a buffer. Either way it is closed by lread_close. */
+int lread_open(char* filename, lsource* s);
+void lread_close(lsource* s);
+
+/* Read the whole of file 'filename' as lread does */
+lval* lread_file(char* filename);
+
+#endif
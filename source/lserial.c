@@ -0,0 +1,371 @@
+/*========================================= Includes =========================================*/
+
+// Standard Include
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Local Include
+#include "lisputils.h"
+#include "lvalue.h"
+#include "lsymbol.h"
+#include "lenviron.h"
+#include "lread.h"
+
+// Header Include
+#include "lserial.h"
+
+/*===================================== Writing =====================================*/
+
+/* Size of the buffer of a file being written */
+#define LBUF_FILE_CAP (1 << 16)
+
+static void lbuf_reserve(lbuf* b, long n) {
+	if (b->len + n <= b->cap) { return; }
+	if (b->out != NULL) { lbuf_flush(b); }
+	if (b->len + n <= b->cap) { return; }
+	while (b->len + n > b->cap) { b->cap = b->cap ? b->cap * 2 : 256; }
+	b->data = realloc(b->data, b->cap);
+}
+
+void lbuf_byte(lbuf* b, unsigned char c) {
+	lbuf_reserve(b, 1);
+	b->data[b->len++] = (char)c;
+}
+
+void lbuf_varint(lbuf* b, unsigned long x) {
+	lbuf_reserve(b, 10);
+	while (x >= 0x80) {
+		b->data[b->len++] = (char)(x | 0x80);
+		x >>= 7;
+	}
+	b->data[b->len++] = (char)x;
+}
+
+void lbuf_text(lbuf* b, char* s, long n) {
+	lbuf_varint(b, (unsigned long)n);
+	lbuf_reserve(b, n);
+	memcpy(b->data + b->len, s, n);
+	b->len += n;
+}
+
+void lbuf_file(lbuf* b, FILE* out) {
+	b->data = malloc(LBUF_FILE_CAP);
+	b->len = 0;
+	b->cap = LBUF_FILE_CAP;
+	b->out = out;
+}
+
+void lbuf_flush(lbuf* b) {
+	if (b->out == NULL || b->len == 0) { return; }
+	fwrite(b->data, 1, b->len, b->out);
+	b->len = 0;
+}
+
+void lbuf_free(lbuf* b) {
+	free(b->data);
+	b->data = NULL;
+	b->len = b->cap = 0;
+}
+
+void lserial_write(lbuf* b, lval* v) {
+	lbuf_byte(b, (unsigned char)v->type);
+
+	switch (v->type) {
+		/* Zigzag, so small negative numbers stay short */
+		case LVAL_NUM:
+			lbuf_varint(b, ((unsigned long)v->num << 1) ^ (unsigned long)(v->num >> (sizeof(long) * 8 - 1)));
+		break;
+
+		case LVAL_ERR: lbuf_text(b, v->err, strlen(v->err)); break;
+		case LVAL_SYM: lbuf_text(b, v->sym, strlen(v->sym)); break;
+		case LVAL_STR: lbuf_text(b, v->str, strlen(v->str)); break;
+
+		case LVAL_SEXPR:
+		case LVAL_QEXPR:
+			lbuf_varint(b, (unsigned long)v->count);
+			for (int i = 0; i < v->count; i++) { lserial_write(b, v->cell[i]); }
+		break;
+
+		case LVAL_DBL: {
+			uint64_t bits;
+			memcpy(&bits, &v->dbl, sizeof(bits));
+			lbuf_reserve(b, 8);
+			for (int j = 0; j < 64; j += 8) { b->data[b->len++] = (char)(bits >> j); }
+		}
+		break;
+
+		/* Ints and the bits of doubles alike */
+		case LVAL_PACK:
+			lbuf_byte(b, (unsigned char)v->pack.kind);
+			lbuf_varint(b, (unsigned long)v->pack.count);
+			for (long i = 0; i < v->pack.count; i++) {
+				uint64_t bits = ((uint64_t*)v->pack.data)[i];
+				lbuf_reserve(b, 8);
+				for (int j = 0; j < 64; j += 8) { b->data[b->len++] = (char)(bits >> j); }
+			}
+		break;
+
+		case LVAL_BIGNUM:
+			lbuf_varint(b, (unsigned long)v->big.len);
+			lbuf_byte(b, v->big.sign < 0);
+			lbuf_reserve(b, 4L * v->big.len);
+			for (int i = 0; i < v->big.len; i++) {
+				for (int j = 0; j < 32; j += 8) { b->data[b->len++] = (char)(v->big.d[i] >> j); }
+			}
+		break;
+
+		/* Builtins by name, as their addresses differ between runs */
+		case LVAL_FUN:
+			if (v->builtin != NULL) {
+				char* name = lenv_builtin_name(v->builtin);
+				if (name == NULL) { name = ""; }
+				lbuf_byte(b, LSERIAL_BUILTIN);
+				lbuf_text(b, name, strlen(name));
+				break;
+			}
+			lbuf_byte(b, v->bound != NULL ? LSERIAL_PARTIAL : LSERIAL_LAMBDA);
+			if (v->bound != NULL) { lserial_write(b, v->bound); }
+			lserial_write(b, v->formals);
+			lserial_write(b, v->body);
+		break;
+	}
+}
+
+/*===================================== Reading =====================================*/
+
+int lserial_varint(char** p, char* end, unsigned long* x) {
+	*x = 0;
+	for (int shift = 0; *p < end && shift < 64; shift += 7) {
+		unsigned char c = (unsigned char)*(*p)++;
+		*x |= (unsigned long)(c & 0x7f) << shift;
+		if (!(c & 0x80)) { return 1; }
+	}
+	return 0;
+}
+
+char* lserial_text(char** p, char* end, char* buf, long size) {
+	unsigned long n;
+	if (!lserial_varint(p, end, &n) || n > (unsigned long)(end - *p)) { return NULL; }
+
+	char* s = (long)n < size ? buf : malloc(n + 1);
+	memcpy(s, *p, n);
+	s[n] = '\0';
+	*p += n;
+	return s;
+}
+
+/* Lists and functions nested deeper than this are taken as malformed, */
+/* as decoding recurses once per level and would overflow the C stack */
+#define LSERIAL_MAX_DEPTH 10000
+
+static lval* lserial_read_at(char** p, char* end, int depth);
+
+/* A list of the count of items read next, or NULL if malformed */
+static lval* lserial_read_list(char** p, char* end, lval* v, int depth) {
+	unsigned long n;
+	if (!lserial_varint(p, end, &n)) { lval_del(v); return NULL; }
+
+	for (unsigned long i = 0; i < n; i++) {
+		lval* x = lserial_read_at(p, end, depth + 1);
+		if (x == NULL) { lval_del(v); return NULL; }
+		v = lval_add(v, x);
+	}
+	return v;
+}
+
+/* A Bignum of the digits read next, or NULL if malformed */
+static lval* lserial_read_bignum(char** p, char* end) {
+	unsigned long n;
+	if (!lserial_varint(p, end, &n) || n == 0 || *p >= end
+		|| n > (unsigned long)(end - *p - 1) / 4) { return NULL; }
+	int neg = *(*p)++;
+
+	uint32_t* d = malloc(sizeof(uint32_t) * n);
+	for (unsigned long i = 0; i < n; i++) {
+		unsigned char* q = (unsigned char*)*p + 4 * i;
+		d[i] = (uint32_t)q[0] | (uint32_t)q[1] << 8 | (uint32_t)q[2] << 16 | (uint32_t)q[3] << 24;
+	}
+	*p += 4 * n;
+
+	/* Leading zero digits are never written */
+	lval* x = NULL;
+	if ((neg == 0 || neg == 1) && d[n - 1] != 0) {
+		lbig view = { neg ? -1 : 1, (int)n, 0, d };
+		lbig b;
+		lbig_copy(&b, &view);
+		x = lval_bignum(&b);
+	}
+	free(d);
+	return x;
+}
+
+/* A Packed Vector of the kind and elements read next, or NULL if malformed */
+static lval* lserial_read_pack(char** p, char* end) {
+	if (*p >= end) { return NULL; }
+	int kind = *(*p)++;
+	unsigned long n;
+	if ((kind != LPACK_INT && kind != LPACK_DBL) || !lserial_varint(p, end, &n)
+		|| n > (unsigned long)(end - *p) / 8) { return NULL; }
+
+	lpack pack;
+	lpack_alloc(&pack, kind, (long)n);
+	uint64_t* d = pack.data;
+	for (unsigned long i = 0; i < n; i++) {
+		unsigned char* q = (unsigned char*)*p + 8 * i;
+		d[i] = 0;
+		for (int j = 0; j < 8; j++) { d[i] |= (uint64_t)q[j] << (8 * j); }
+	}
+	*p += 8 * n;
+	return lval_pack(&pack);
+}
+
+/* Whether 'formals' are symbols as lval_call expects them, with at most */
+/* one '&', followed by exactly one symbol, and no more arguments       */
+/* 'bound' than formals                                                 */
+static int lserial_formals_ok(lval* formals, lval* bound) {
+	char* amp = lsym_intern("&");
+	for (int i = 0; i < formals->count; i++) {
+		if (formals->cell[i]->type != LVAL_SYM) { return 0; }
+		/* Only the one before last may be '&' */
+		if (formals->cell[i]->sym == amp && i != formals->count - 2) { return 0; }
+	}
+	return bound == NULL || bound->count <= formals->count;
+}
+
+/* A function of the kind read next, or NULL if malformed */
+static lval* lserial_read_fun(char** p, char* end, int depth) {
+	if (*p >= end) { return NULL; }
+	int kind = *(*p)++;
+
+	if (kind == LSERIAL_BUILTIN) {
+		char buf[64];
+		char* name = lserial_text(p, end, buf, sizeof(buf));
+		if (name == NULL) { return NULL; }
+		lbuiltin func = lenv_builtin_func(name);
+		if (name != buf) { free(name); }
+		return func != NULL ? lval_fun(func) : NULL;
+	}
+	if (kind != LSERIAL_LAMBDA && kind != LSERIAL_PARTIAL) { return NULL; }
+
+	/* Each part must be a list, as lambdas are called assuming so */
+	lval* parts[3] = { NULL, NULL, NULL };
+	int count = kind == LSERIAL_PARTIAL ? 3 : 2;
+	for (int i = 0; i < count; i++) {
+		parts[i] = lserial_read_at(p, end, depth + 1);
+		if (parts[i] == NULL || (parts[i]->type != LVAL_SEXPR && parts[i]->type != LVAL_QEXPR)) {
+			for (int j = 0; j <= i; j++) { if (parts[j] != NULL) { lval_del(parts[j]); } }
+			return NULL;
+		}
+	}
+
+	lval* formals = parts[count - 2];
+	if (!lserial_formals_ok(formals, kind == LSERIAL_PARTIAL ? parts[0] : NULL)) {
+		for (int j = 0; j < count; j++) { lval_del(parts[j]); }
+		return NULL;
+	}
+
+	if (kind == LSERIAL_LAMBDA) { return lval_lambda(parts[0], parts[1]); }
+	lval* f = lval_lambda(parts[1], parts[2]);
+	f->bound = parts[0];
+	return f;
+}
+
+/* The value at '*p', nested 'depth' lists and functions deep */
+static lval* lserial_read_at(char** p, char* end, int depth) {
+	if (*p >= end || depth > LSERIAL_MAX_DEPTH) { return NULL; }
+	int type = *(*p)++;
+
+	switch (type) {
+		case LVAL_NUM: {
+			unsigned long z;
+			if (!lserial_varint(p, end, &z)) { return NULL; }
+			return lval_num((long)(z >> 1) ^ -(long)(z & 1));
+		}
+
+		case LVAL_ERR:
+		case LVAL_SYM:
+		case LVAL_STR: {
+			char buf[64];
+			char* s = lserial_text(p, end, buf, sizeof(buf));
+			if (s == NULL) { return NULL; }
+			lval* x = type == LVAL_ERR ? lval_err("%s", s)
+				: type == LVAL_SYM ? lval_sym(s) : lval_str(s);
+			if (s != buf) { free(s); }
+			return x;
+		}
+
+		case LVAL_SEXPR: return lserial_read_list(p, end, lval_sexpr(), depth);
+		case LVAL_QEXPR: return lserial_read_list(p, end, lval_qexpr(), depth);
+		case LVAL_FUN:   return lserial_read_fun(p, end, depth);
+		case LVAL_BIGNUM: return lserial_read_bignum(p, end);
+		case LVAL_PACK:   return lserial_read_pack(p, end);
+
+		case LVAL_DBL: {
+			if (end - *p < 8) { return NULL; }
+			uint64_t bits = 0;
+			for (int j = 0; j < 8; j++) { bits |= (uint64_t)(unsigned char)(*p)[j] << (8 * j); }
+			*p += 8;
+			double x;
+			memcpy(&x, &bits, sizeof(x));
+			return lval_dbl(x);
+		}
+	}
+
+	return NULL;
+}
+
+lval* lserial_read(char** p, char* end) {
+	return lserial_read_at(p, end, 0);
+}
+
+/*===================================== Files =====================================*/
+
+lval* lserial_save(char* filename, lval* v) {
+	FILE* f = fopen(filename, "wb");
+	if (f == NULL) { return lval_err("Could not write '%s'", filename); }
+
+	/* Streamed through a fixed buffer, however large the value */
+	lbuf b;
+	lbuf_file(&b, f);
+	lbuf_text(&b, LSERIAL_MAGIC, strlen(LSERIAL_MAGIC));
+	lbuf_varint(&b, LSERIAL_VERSION);
+	lserial_write(&b, v);
+	lbuf_flush(&b);
+	lbuf_free(&b);
+
+	int failed = ferror(f);
+	if (fclose(f) != 0 || failed) { return lval_err("Could not write '%s'", filename); }
+	return lval_sexpr();
+}
+
+/* The value encoded in 'p', checking what comes before it */
+static lval* lserial_decode(char* filename, char* p, char* end) {
+	char magic[16];
+	char* m = lserial_text(&p, end, magic, sizeof(magic));
+	int is_value = m != NULL && strcmp(m, LSERIAL_MAGIC) == 0;
+	if (m != magic) { free(m); }
+	if (!is_value) { return lval_err("'%s' is not a serialized value", filename); }
+
+	unsigned long version;
+	if (!lserial_varint(&p, end, &version) || version < 1 || version > LSERIAL_VERSION) {
+		return lval_err("'%s' is serialized in another version", filename);
+	}
+
+	lval* v = lserial_read(&p, end);
+	if (v == NULL) { return lval_err("'%s' is malformed", filename); }
+	if (p != end) {
+		lval_del(v);
+		return lval_err("'%s' is malformed", filename);
+	}
+	return v;
+}
+
+lval* lserial_load(char* filename) {
+	lsource s;
+	if (!lread_open(filename, &s)) { return lval_err("Could not read '%s'", filename); }
+
+	lval* v = lserial_decode(filename, s.src, s.src + s.len);
+	lread_close(&s);
+	return v;
+}
@@ -0,0 +1,78 @@
+#ifndef LSERIAL_HEADER
+#define LSERIAL_HEADER
+
+// Standard Include
+#include <stdio.h>
+
+/* Forward declare dependencies */
+struct lval;
+typedef struct lval lval;
+
+/*===================================== Encoding =====================================*/
+
+/* Values are written depth first, each as a tag byte, its type, then:   */
+/*   Number          the value zigzag encoded as a varint                */
+/*   Error, Symbol,  the length of the text as a varint, then the text   */
+/*   String                                                              */
+/*   S/Q-Expression  the count of items as a varint, then the items      */
+/*   Bignum          the count of digits as a varint, a sign byte of 1   */
+/*                   when negative, then the 32 bit digits as 4 bytes    */
+/*                   each, least significant first                      */
+/*   Double          its 8 bytes as an IEEE 754 double, least           */
+/*                   significant first                                   */
+/*   Packed Vector   a kind byte, the count as a varint, then each       */
+/*                   element's 8 bytes, least significant first          */
+/*   Function        a kind byte, then for a builtin the name it was     */
+/*                   added under as text, for a lambda its formals and   */
+/*                   body, and for a partial application its bound       */
+/*                   arguments, formals and body                         */
+/* Varints hold 7 bits a byte, least significant first, with the top bit */
+/* set on every byte but the last.                                       */
+enum { LSERIAL_BUILTIN, LSERIAL_LAMBDA, LSERIAL_PARTIAL };
+
+/* Files written by serialize start with this and the version of the */
+/* encoding, which changes whenever the encoding does. Every version */
+/* only adds to the one before, so earlier versions are read too.    */
+#define LSERIAL_MAGIC "lispyval"
+#define LSERIAL_VERSION 4
+
+/*===================================== Struct Definitions =====================================*/
+
+/* Bytes written, growing as needed. With 'out' set the bytes are */
+/* written to it whenever the buffer fills rather than growing it. */
+typedef struct lbuf {
+	char* data;
+	long len;
+	long cap;
+	FILE* out;
+} lbuf;
+
+/*===================================== Declared Functions =====================================*/
+
+/* Append to 'b', which starts zeroed, or set up by lbuf_file to write */
+/* to 'out', and is freed by lbuf_free once flushed                    */
+void lbuf_file(lbuf* b, FILE* out);
+void lbuf_byte(lbuf* b, unsigned char c);
+void lbuf_varint(lbuf* b, unsigned long x);
+void lbuf_text(lbuf* b, char* s, long n);
+void lbuf_flush(lbuf* b);
+void lbuf_free(lbuf* b);
+
+/* Append the encoding of 'v' to 'b' */
+void lserial_write(lbuf* b, lval* v);
+
+/* Decode starting at '*p', no further than 'end', moving '*p' past what */
+/* was read. Malformed input gives 0 or NULL, never reading past 'end'.  */
+/* Text is returned as a string ending in '\0', in 'buf' if it fits in  */
+/* 'size' bytes, otherwise allocated and to be freed by the caller.      */
+int lserial_varint(char** p, char* end, unsigned long* x);
+char* lserial_text(char** p, char* end, char* buf, long size);
+lval* lserial_read(char** p, char* end);
+
+/* Write 'v' to file 'filename' as it is encoded, giving an empty       */
+/* S-Expression or an error. Read it back from the file, decoded in    */
+/* place from the mapped file, giving the value or an error.           */
+lval* lserial_save(char* filename, lval* v);
+lval* lserial_load(char* filename);
+
+#endif
@@ -0,0 +1,99 @@
+
+/*========================================= Includes =========================================*/
+
+// Standard Include
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Header Include
+#include "lsymbol.h"
+
+/*===================================== Struct Definitions =====================================*/
+
+/* An interned symbol. The name is stored inline after its hash so the */
+/* hash and binding count can be recovered from the name pointer alone. */
+typedef struct lsym {
+	unsigned long hash;
+	int binds;
+	char name[];
+} lsym;
+
+#define LSYM(sym) ((lsym*)((sym) - offsetof(lsym, name)))
+
+/* Open-addressing table of every interned symbol */
+static lsym** table = NULL;
+static int count = 0;
+static int cap = 0;
+
+/*===================================== Defined Functions =====================================*/
+
+/* FNV-1a hash of a symbol name */
+static unsigned long lsym_hash_str(char* s) {
+	unsigned long h = 14695981039346656037UL;
+	while (*s) {
+		h ^= (unsigned char)*s++;
+		h *= 1099511628211UL;
+	}
+	return h;
+}
+
+/* Double the table size and re-insert every symbol */
+static void lsym_grow(void) {
+	int old_cap = cap;
+	lsym** old_table = table;
+
+	cap = old_cap ? old_cap * 2 : 256;
+	table = calloc(cap, sizeof(lsym*));
+
+	for (int i = 0; i < old_cap; i++) {
+		if (old_table[i] == NULL) { continue; }
+		int j = (int)(old_table[i]->hash & (cap - 1));
+		while (table[j] != NULL) { j = (j + 1) & (cap - 1); }
+		table[j] = old_table[i];
+	}
+
+	free(old_table);
+}
+
+char* lsym_intern(char* name) {
+
+	/* Keep the load factor at or below 1/2 */
+	if ((count + 1) * 2 > cap) { lsym_grow(); }
+
+	/* Probe for an existing symbol with this name */
+	unsigned long h = lsym_hash_str(name);
+	int i = (int)(h & (cap - 1));
+	while (table[i] != NULL) {
+		if (table[i]->hash == h && strcmp(table[i]->name, name) == 0) {
+			return table[i]->name;
+		}
+		i = (i + 1) & (cap - 1);
+	}
+
+	/* Not found so add it to the empty slot */
+	lsym* s = malloc(sizeof(lsym) + strlen(name) + 1);
+	s->hash = h;
+	s->binds = 0;
+	strcpy(s->name, name);
+	table[i] = s;
+	count++;
+
+	return s->name;
+}
+
+unsigned long lsym_hash(char* sym) {
+	return LSYM(sym)->hash;
+}
+
+void lsym_bind(char* sym)     { LSYM(sym)->binds++; }
+void lsym_unbind(char* sym)   { LSYM(sym)->binds--; }
+int lsym_bindings(char* sym)  { return LSYM(sym)->binds; }
+
+void lsym_cleanup(void) {
+	for (int i = 0; i < cap; i++) { free(table[i]); }
+	free(table);
+	table = NULL;
+	count = 0;
+	cap = 0;
+}
@@ -0,0 +1,20 @@
+#ifndef LSYMBOL_HEADER
+#define LSYMBOL_HEADER
+
+/*===================================== Declared Functions =====================================*/
+
+/* Symbols are interned into a single global pool. Interning the same */
+/* name twice returns the same pointer, so symbols can be copied and  */
+/* compared as pointers. Interned names live until lsym_cleanup.      */
+char* lsym_intern(char* name);
+unsigned long lsym_hash(char* sym);
+
+/* Count of environments binding each symbol, kept by lenviron.c. A */
+/* symbol bound only once is bound in the global environment if it  */
+/* is bound there at all, so lookups can skip the caller chain.     */
+void lsym_bind(char* sym);
+void lsym_unbind(char* sym);
+int lsym_bindings(char* sym);
+void lsym_cleanup(void);
+
+#endif
@@ -3,6 +3,7 @@
 
 // Standard Include
 #include <errno.h>
+#include <math.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -13,6 +14,11 @@
 
 // Local Include
 #include "lisputils.h"
+#include "lsymbol.h"
+#include "lalloc.h"
+#include "lcompile.h"
+#include "lvm.h"
+#include "lprof.h"
 #include "builtin.h"
 #include "lenviron.h"
 
@@ -21,40 +27,79 @@
 
 /*===================================== Defined Functions =====================================*/
 
+/* Shared small numbers, see LVAL_IMMORTAL */
+static lval small_nums[LVAL_SMALL_MAX - LVAL_SMALL_MIN + 1];
+
+/* Allocate an lval with a single reference, every constructor goes through here */
+static lval* lval_alloc(int type) {
+	lval* v = lalloc_lval(type);
+	v->type = type;
+	v->ref = 1;
+	return v;
+}
+
+/* A call in tail position is not made where it is found. Instead it is */
+/* stored here and this marker is returned up to lval_apply, which     */
+/* makes the call in a loop, so tail calls run in constant C stack.    */
+static lval tail_marker;
+static lenv* tail_env;
+static lval* tail_fun;
+static lval* tail_args;
+
+/* Older frames of a tail call chain checked for being shadowed */
+#define LVAL_TAIL_SCAN 8
+
 lval* lval_call(lenv* e, lval* f, lval* a) {
+	/* Variadic marker, interned once so it compares by pointer */
+	static char* amp = NULL;
+	if (amp == NULL) { amp = lsym_intern("&"); }
+
 	/* If Builtin then simply call that */
 	if (f->builtin != NULL) { return f->builtin(e, a); }
 
-	/* Record Argument Counts */
-	int given = a->count;
+	lval** formals = f->formals->cell;
 	int total = f->formals->count;
+	int given = a->count;
+	int bound = f->bound != NULL ? f->bound->count : 0;
+
+	/* Formals before any '&' must all be given for the body to run */
+	int needed = 0;
+	while (needed < total && formals[needed]->sym != amp) { needed++; }
+
+	/* Otherwise return a partial application holding the arguments */
+	if (bound + given < needed) { return lval_partial(f, a); }
+
+	/* Arguments are bound into a fresh frame, starting with any given */
+	/* to a partial application, so the function is never changed     */
+	lenv* frame = lenv_frame(total);
+	for (int i = 0; i < bound; i++) { lenv_put(frame, formals[i], f->bound->cell[i]); }
 
 	while (a->count) {
 
 		/* If we've ran out of formal arguments to bind */
-		if(f->formals->count == 0) {
+		if(bound == total) {
+			lenv_del(frame);
 			lval_del(a); 
 			return lval_err("Function passed too many arguments. "
-			"Got %d, Expected %d", given, total);
+			"Got %d, Expected %d", given, total - (f->bound != NULL ? f->bound->count : 0));
 		}
 
-		/* Pop the first symbol from the formals */
-		lval* sym = lval_pop(f->formals, 0);
+		/* Take the next symbol from the formals */
+		lval* sym = formals[bound++];
 
 		/* Special Case to deal with '&' */
-		if (strcmp(sym->sym, "&") == 0) {
+		if (sym->sym == amp) {
 
 			/* Ensure '&' is followed by another symbol */
-			if (f->formals->count != 1) {
+			if (bound != total - 1) {
+				lenv_del(frame);
 				lval_del(a);
 				return lval_err("Function format invalid. "
 					"Symbol '&' not followed by single symbol");
 			}
 
 			/* Next formal should be bound to remaining arguments */
-			lval* nsym = lval_pop(f->formals, 0);
-			lenv_put(f->env, nsym, builtin_list(e, a));
-			lval_del(sym); lval_del(nsym);
+			lenv_put(frame, formals[bound++], builtin_list(e, a));
 			break;
 		
 		}
@@ -62,69 +107,148 @@ lval* lval_call(lenv* e, lval* f, lval* a) {
 		/* Pop the next argument from the list */
 		lval* val = lval_pop(a, 0);
 
-		/* Bind a copy into the function's environment */
-		lenv_put(f->env, sym, val);
+		/* Bind a copy into the frame */
+		lenv_put(frame, sym, val);
 
-		/* Delete symbol and value */
-		lval_del(sym); lval_del(val);
+		/* Delete value */
+		lval_del(val);
 	}
 
 	/* Argument list is now bound so can be cleaned up */
 	lval_del(a);
 
 	/* If '&' remains in formal list bind to empty list */
-	if(f->formals->count > 0 && 
-		strcmp(f->formals->cell[0]->sym, "&") == 0) {
+	if(bound < total && formals[bound]->sym == amp) {
 		
 		/* Check to ensure that & is not passed invalidly */
-		if (f->formals->count != 2) {
-		return lval_err("Function format invalid. "
-			"Symbol '&' not followed by a single symbol.");
+		if (total - bound != 2) {
+			lenv_del(frame);
+			return lval_err("Function format invalid. "
+				"Symbol '&' not followed by a single symbol.");
 		}
 
-		/* Pop and delete the '&' symbol */
-		lval_del(lval_pop(f->formals, 0));
-
-		/* Pop next symbol and create empty list */
-		lval* sym = lval_pop(f->formals, 0);
+		/* Bind next symbol to an empty list */
 		lval* val = lval_qexpr();
-
-		/* Bind to environment and delete */
-		lenv_put(f->env, sym, val);
-		lval_del(sym); lval_del(val);
+		lenv_put(frame, formals[bound + 1], val);
+		lval_del(val);
+		bound += 2;
 	}
 
-	/* If all formals have been bound evaluate */
-	if (f->formals->count == 0) {
+	/* Set environment parent to evaluation environment */
+	frame->par = e;
 
-		/* Set environment parent to evaluation environment */
-		f->env->par = e;
+	/* Compiled bodies run on the VM, otherwise evaluate, */
+	/* the body being in tail position                    */
+	lval* result = f->code != NULL
+		? lvm_exec(f->code, frame)
+		: lval_eval_tail(frame, builtin_eval_tail(frame,
+			lval_add(lval_sexpr(), lval_copy(f->body))));
 
-		/* Evaluate and return */
-		return builtin_eval( f->env, 
-			lval_add( lval_sexpr(), lval_copy(f->body) ));				
-	} 
-	else {
-		/* Otherwise return partially evaluated function */
-		return lval_copy(f);
+	/* A tail call passes the frame on to lval_apply */
+	if (result != &tail_marker) { lenv_del(frame); }
+	return result;
+}
+
+
+/* Create an empty cell buffer with room for 'cap' items */
+static lvec* lvec_new(int cap) {
+	lvec* b = malloc(sizeof(lvec) + sizeof(lval*) * cap);
+	lalloc_bytes(sizeof(lvec) + sizeof(lval*) * cap);
+	b->ref = 1;
+	b->cap = cap;
+	b->used = 0;
+	return b;
+}
+
+/* Release a reference to a cell buffer, freeing it and its items when none remain */
+static void lvec_release(lvec* b) {
+	if (--b->ref > 0) { return; }
+	for (int i = 0; i < b->used; i++) {
+		if (b->items[i] != NULL) { lval_del(b->items[i]); }
 	}
+	lalloc_bytes(-(long)(sizeof(lvec) + sizeof(lval*) * b->cap));
+	free(b);
 }
 
+/* Make 'v' the sole viewer of a buffer with room for 'extra' more cells */
+/* 'v' itself must already be unshared                                  */
+static void lval_reserve(lval* v, int extra) {
+	lvec* b = v->vec;
+	int need = v->count + extra;
+
+	/* Nothing to hold */
+	if (b == NULL && need == 0) { return; }
+
+	/* No buffer, or one that other lists view: copy our slice into a new one */
+	if (b == NULL || b->ref > 1) {
+		lvec* n = lvec_new(need < 4 ? 4 : need);
+		for (int i = 0; i < v->count; i++) {
+			n->items[i] = lval_copy(v->cell[i]);
+		}
+		n->used = v->count;
+		if (b != NULL) { b->ref--; }
+		v->vec = n;
+		v->cell = n->items;
+		return;
+	}
+
+	/* Items past our slice are no longer visible to anyone, release them */
+	int off = (int)(v->cell - b->items);
+	for (int i = off + v->count; i < b->used; i++) {
+		if (b->items[i] != NULL) { lval_del(b->items[i]); }
+	}
+	b->used = off + v->count;
+	if (b->used + extra <= b->cap) { return; }
+
+	/* Out of room at the end, so first reclaim the space before our slice */
+	if (off > 0) {
+		for (int i = 0; i < off; i++) {
+			if (b->items[i] != NULL) { lval_del(b->items[i]); }
+		}
+		memmove(b->items, v->cell, sizeof(lval*) * v->count);
+		b->used = v->count;
+		v->cell = b->items;
+	}
+
+	/* Then grow geometrically so appends are amortized O(1) */
+	if (need > b->cap) {
+		lalloc_bytes(-(long)(sizeof(lval*) * b->cap));
+		b->cap = need > b->cap * 2 ? need : b->cap * 2;
+		lalloc_bytes(sizeof(lval*) * b->cap);
+		b = realloc(b, sizeof(lvec) + sizeof(lval*) * b->cap);
+		v->vec = b;
+		v->cell = b->items;
+	}
+}
 
 /* Take an lval out of a list and return it */
+/* 'v' must be unshared. Popping either end is O(1) even when the */
+/* buffer is shared, as only the slice 'v' views has to move.     */
 lval* lval_pop(lval* v, int i) {
+	/* Removing from the middle of a shared buffer needs a private copy */
+	int end = (i == 0 || i == v->count-1);
+	if (!end && v->vec->ref > 1) { lval_reserve(v, 0); }
+
 	/* Find the item at "i" */
 	lval* x = v->cell[i];
 
-	/* Shift memory after the item at "i" over the top */
-	memmove( &v->cell[i], &v->cell[i+1], sizeof(lval*) * (v->count-i-1) );
+	if (v->vec->ref > 1) {
+		/* The shared buffer keeps its reference, so take another */
+		lval_copy(x);
+		if (i == 0) { v->cell++; }
+	} else if (i == 0) {
+		/* Take the buffer's reference and move the slice start past it */
+		v->cell[0] = NULL;
+		v->cell++;
+	} else {
+		/* Shift memory after the item at "i" over the top */
+		memmove( &v->cell[i], &v->cell[i+1], sizeof(lval*) * (v->count-i-1) );
+		v->cell[v->count-1] = NULL;
+	}
 
 	/* Decrease the count of items in the list */
 	v->count--;
 
-	/* Reallocate the memory used */
-	v->cell = realloc( v->cell, sizeof(lval*) * v->count );
-
 	return x;
 }
 
@@ -135,11 +259,22 @@ lval* lval_take(lval* v, int i) {
 	return x;
 }
 
-lval* lval_eval_sexpr(lenv* e, lval* v) {
-	
+/* Evaluate the children of S-expression 'v'. If it is a call the     */
+/* function is popped into 'f' and the arguments returned. Otherwise   */
+/* 'f' is NULL and the first error, or the value of () or (x), returned. */
+static lval* lval_eval_args(lenv* e, lval* v, lval** f) {
+	*f = NULL;
+
+	/* Children are replaced as they are evaluated */
+	v = lval_unshare(v);
+	lval_reserve(v, 0);
+
 	/* Evaluate Children */
+	/* A child is detached while evaluating, as evaluation consumes it */
 	for(int i = 0; i < v->count; i++) {
-		v->cell[i] = lval_eval(e, v->cell[i]);
+		lval* x = v->cell[i];
+		v->cell[i] = NULL;
+		v->cell[i] = lval_eval(e, x);
 	}
 
 	/* Error Checking */
@@ -153,21 +288,120 @@ lval* lval_eval_sexpr(lenv* e, lval* v) {
 	/* Single Expression */
 	if (v->count == 1) { return lval_take(v, 0); }
 
+	/* Call the first element with the rest as arguments */
+	*f = lval_pop(v, 0);
+	return v;
+}
+
+lval* lval_eval_sexpr(lenv* e, lval* v) {
+	lval* f;
+	v = lval_eval_args(e, v, &f);
+	return f != NULL ? lval_apply(e, f, v) : v;
+}
+
+/* Make the call (f a...) in tail position, consuming 'f' and 'a'. The */
+/* result is either the value or the tail marker for lval_apply.       */
+lval* lval_tail(lenv* e, lval* f, lval* a) {
+
+	/* Only calls which evaluate further code are deferred */
+	if (f->type != LVAL_FUN || (f->builtin != NULL
+		&& f->builtin != builtin_if && f->builtin != builtin_eval)) {
+		return lval_apply(e, f, a);
+	}
+
+	tail_env = e;
+	tail_fun = f;
+	tail_args = a;
+	return &tail_marker;
+}
+
+/* Evaluate 'v', leaving a call in tail position to the caller */
+lval* lval_eval_tail(lenv* e, lval* v) {
+	/* The value of (x) is that of x, so x is in tail position too */
+	while (v->type == LVAL_SEXPR && v->count == 1) { v = lval_take(v, 0); }
+	if (v->type != LVAL_SEXPR) { return lval_eval(e, v); }
+
+	lval* f;
+	v = lval_eval_args(e, v, &f);
+	return f != NULL ? lval_tail(e, f, v) : v;
+}
+
+/* Call 'f' with argument list 'a', consuming both */
+lval* lval_apply(lenv* e, lval* f, lval* a) {
+
 	/* Ensure First Element is a function after evaluation */
-	lval* f = lval_pop(v, 0);
 	if (f->type != LVAL_FUN) {
 		lval* err = lval_err(
 			"S-Expression starts with incorrect type. "
 			"Got %s, Expected %s.", 
 			ltype_name(f->type), ltype_name(LVAL_FUN));
 		lval_del(f);
-		lval_del(v);
+		lval_del(a);
 		return err;
 	}
 
-	/* If so call function to get result */
-	lval* result = lval_call(e, f, v);
-	lval_del(f);
+	/* Frames of lambdas whose bodies made tail calls. They stay on */
+	/* the caller chain of the calls that follow, as variables are  */
+	/* looked up dynamically, until a later frame shadows them all. */
+	lenv* frames_local[LVAL_TAIL_SCAN];
+	lenv** frames = frames_local;
+	int nframes = 0;
+	int cap = LVAL_TAIL_SCAN;
+
+	lval* result;
+	for (;;) {
+		int lambda = f->builtin == NULL;
+		if (lprof_enabled) { lprof_enter(f); }
+
+		if (f->builtin == builtin_if || f->builtin == builtin_eval) {
+			/* Evaluate the chosen expression here rather than nesting */
+			lval* x = f->builtin == builtin_if ? builtin_if_tail(e, a) : builtin_eval_tail(e, a);
+			lval_del(f);
+			result = lval_eval_tail(e, x);
+		} else if (f->builtin != NULL) {
+			result = f->builtin(e, a);
+			lval_del(f);
+		} else {
+			/* Compile first so every copy shares the code */
+			lvm_prepare(f);
+			result = lval_call(e, f, a);
+			lval_del(f);
+		}
+		if (lprof_enabled) { lprof_exit(); }
+
+		if (result != &tail_marker) { break; }
+
+		/* A lambda's tail call is made from its frame, which is now ours */
+		if (lambda) {
+			lenv* frame = tail_env;
+			if (nframes == cap) {
+				cap *= 2;
+				lenv** grown = malloc(sizeof(lenv*) * cap);
+				memcpy(grown, frames, sizeof(lenv*) * nframes);
+				if (frames != frames_local) { free(frames); }
+				frames = grown;
+			}
+			frames[nframes++] = frame;
+
+			/* Unlink recent frames the new one hides entirely */
+			for (int i = nframes - 2; i >= 0 && i >= nframes - 1 - LVAL_TAIL_SCAN; i--) {
+				if (!lenv_shadows(frame, frames[i])) { continue; }
+				frames[i + 1]->par = frames[i]->par;
+				lenv_del(frames[i]);
+				memmove(frames + i, frames + i + 1, sizeof(lenv*) * (nframes - i - 1));
+				nframes--;
+			}
+		}
+
+		/* Make the deferred call */
+		e = tail_env;
+		f = tail_fun;
+		a = tail_args;
+	}
+
+	/* The chain has returned so no frame is visible any more */
+	for (int i = 0; i < nframes; i++) { lenv_del(frames[i]); }
+	if (frames != frames_local) { free(frames); }
 	return result;
 }
 
@@ -185,12 +419,25 @@ lval* lval_eval(lenv* e, lval* v) {
 
 lval* lval_join(lval* x, lval* y) {
 
-	/* For each cell in 'y' add it to 'x' */
-	while (y->count != 0) {
-		x = lval_add(x, lval_pop(y, 0));
+	/* Make room for all of 'y' at once */
+	x = lval_unshare(x);
+	lval_reserve(x, y->count);
+
+	if (y->ref == 1 && y->vec != NULL && y->vec->ref == 1) {
+		/* If 'y' is ours alone move its cells over */
+		for (int i = 0; i < y->count; i++) {
+			x->cell[x->count++] = y->cell[i];
+			y->cell[i] = NULL;
+		}
+	} else {
+		/* Otherwise share them */
+		for (int i = 0; i < y->count; i++) {
+			x->cell[x->count++] = lval_copy(y->cell[i]);
+		}
 	}
+	if (x->vec != NULL) { x->vec->used += y->count; }
 
-	/* Delete the empty 'y' and return 'x' */
+	/* Delete 'y' and return 'x' */
 	lval_del(y);
 	return x;
 }
@@ -217,10 +464,18 @@ lval* lval_read_str(mpc_ast_t* t) {
 
 
 lval* lval_read_num(mpc_ast_t* t) {
+	/* A fraction or an exponent makes it a Double, as do the spellings */
+	/* of infinities and nans, see lval_print_dbl                       */
+	if (strpbrk(t->contents, ".eE") != NULL) { return lval_dbl(strtod(t->contents, NULL)); }
+
 	errno = 0;
 	long x = strtol(t->contents, NULL, 10);
-	lval* out = errno != ERANGE ? lval_num(x) : lval_err("Invalid number!");
-	return out;
+	if (errno != ERANGE) { return lval_num(x); }
+
+	/* Too large for a long */
+	lbig b;
+	lbig_parse(&b, t->contents, (long)strlen(t->contents));
+	return lval_bignum(&b);
 }
 
 lval* lval_read(mpc_ast_t* t) {
@@ -251,12 +506,13 @@ lval* lval_read(mpc_ast_t* t) {
 }
 
 /* Appends x to end of v's list */
-
+/* If v is shared the append is made to a private copy, which is returned */
 lval* lval_add(lval* v, lval* x) {
 
-	v->count++;
-	v->cell = realloc(v->cell, sizeof(lval*) * v->count);
-	v->cell[v->count-1] = x;
+	v = lval_unshare(v);
+	lval_reserve(v, 1);
+	v->cell[v->count++] = x;
+	v->vec->used++;
 	return v;
 }
 
@@ -277,13 +533,22 @@ void lval_expr_print(lval* v, char open, char close) {
 	putchar(close);
 }
 
+/* Values are immutable once shared, so copying just takes a reference */
 lval* lval_copy(lval* v) {
-	lval* x = malloc(sizeof(lval));
-	x->type = v->type;
+	v->ref++;
+	return v;
+}
+
+/* Duplicate one level of 'v', sharing its children */
+static lval* lval_dup(lval* v) {
+	lval* x = lval_alloc(v->type);
 
 	switch (v->type) {
 		/* Copy Numbers Directly */
 		case LVAL_NUM: x->num = v->num; break;
+		case LVAL_BIGNUM: lbig_copy(&x->big, &v->big); break;
+		case LVAL_DBL: x->dbl = v->dbl; break;
+		case LVAL_PACK: lpack_copy(&x->pack, &v->pack); break;
 
 		case LVAL_FUN: x->builtin = v->builtin; 
 			if(v->builtin != NULL){
@@ -291,9 +556,11 @@ lval* lval_copy(lval* v) {
 			}
 			else {
 				x->builtin = NULL;
-				x->env = lenv_copy(v->env);
+				x->bound = v->bound != NULL ? lval_copy(v->bound) : NULL;
 				x->formals = lval_copy(v->formals);
 				x->body = lval_copy(v->body);
+				x->code = v->code;
+				if (x->code != NULL) { x->code->ref++; }
 			}
 		break;
 
@@ -301,57 +568,119 @@ lval* lval_copy(lval* v) {
 		/* Copy Strings using malloc and strcpy */
 		case LVAL_ERR:
 		 	x->err = malloc(strlen(v->err) + 1);
+		 	lalloc_bytes(strlen(v->err) + 1);
 		 	strcpy(x->err, v->err); break;
-		case LVAL_SYM:
-			x->sym = malloc(strlen(v->sym) + 1);
-			strcpy(x->sym, v->sym); break;
 		case LVAL_STR:
 			x->str = malloc(strlen(v->str) + 1);
+			lalloc_bytes(strlen(v->str) + 1);
 			strcpy(x->str, v->str); break;
 
-		/* Copy Lists by copying each sub-expression */
+		/* Symbols are interned so share the name */
+		case LVAL_SYM: x->sym = v->sym; break;
+
+		/* Copy Lists by sharing the cell buffer */
 		case LVAL_SEXPR:
 		case LVAL_QEXPR:
 			x->count = v->count;
-			x->cell = malloc(sizeof(lval*) * x->count);
-			for(int i = 0; i < x->count; i++) {
-				x->cell[i] = lval_copy(v->cell[i]);
-			}
+			x->cell = v->cell;
+			x->vec = v->vec;
+			if (x->vec != NULL) { x->vec->ref++; }
 		break;
 	}
 
 	return x;
 }
 
+/* Copy on write: return a version of 'v' that is safe to mutate */
+/* If 'v' is shared the reference is swapped for a private copy  */
+lval* lval_unshare(lval* v) {
+	if (v->ref == 1) { return v; }
+	v->ref--;
+	lalloc_stats.copies++;
+	return lval_dup(v);
+}
+
 /* Construct a function lval */
 lval* lval_lambda(lval* formals, lval* body) {
-	lval* v = malloc(sizeof(lval));
-	v->type = LVAL_FUN;
+	lval* v = lval_alloc(LVAL_FUN);
 
 	/* Set Builtin to Null */
 	v->builtin = NULL;
 
-	/* Build new environment */
-	v->env = lenv_new();
+	/* Arguments are bound in a frame made for each call */
+	v->bound = NULL;
 
-	/* Set Formals and Body */
+	/* Set Formals and Body, compiled by lvm_prepare */
 	v->formals = formals;
 	v->body = body;
+	v->code = NULL;
+	return v;
+}
+
+/* Partially apply lambda 'f' to the arguments in 'a', consuming 'a'. */
+/* The result shares everything but the arguments with 'f'.           */
+lval* lval_partial(lval* f, lval* a) {
+	lval* v = lval_alloc(LVAL_FUN);
+	v->builtin = NULL;
+	v->bound = f->bound != NULL ? lval_join(lval_copy(f->bound), a) : a;
+	v->formals = lval_copy(f->formals);
+	v->body = lval_copy(f->body);
+	v->code = f->code;
+	if (v->code != NULL) { v->code->ref++; }
 	return v;
 }
 
 /* Construct a pointer to a new Number lval */
 lval* lval_num(long x) {
-	lval* v = malloc(sizeof(lval));
-	v->type = LVAL_NUM;
+
+	/* Small numbers are shared rather than allocated */
+	if (x >= LVAL_SMALL_MIN && x <= LVAL_SMALL_MAX) {
+		lval* v = &small_nums[x - LVAL_SMALL_MIN];
+		if (v->ref == 0) {
+			v->type = LVAL_NUM;
+			v->ref = LVAL_IMMORTAL;
+			v->num = x;
+		}
+		v->ref++;
+		return v;
+	}
+
+	lval* v = lval_alloc(LVAL_NUM);
 	v->num = x;
 	return v;
 }
 
+/* Construct a Number from 'b', taking its digits. A value that */
+/* fits in a long is always a plain Number, never a Bignum.     */
+lval* lval_bignum(lbig* b) {
+	long x;
+	if (lbig_to_long(b, &x)) {
+		lbig_free(b);
+		return lval_num(x);
+	}
+
+	lval* v = lval_alloc(LVAL_BIGNUM);
+	v->big = *b;
+	return v;
+}
+
+/* Construct a pointer to a new Double lval, held in the lval itself */
+lval* lval_dbl(double x) {
+	lval* v = lval_alloc(LVAL_DBL);
+	v->dbl = x;
+	return v;
+}
+
+/* Construct a Packed Vector from 'p', taking its elements */
+lval* lval_pack(lpack* p) {
+	lval* v = lval_alloc(LVAL_PACK);
+	v->pack = *p;
+	return v;
+}
+
 /* Construct a pointer to a new Error lval */
 lval* lval_err(char* fmt, ...) {
-	lval* v = malloc(sizeof(lval));
-	v->type = LVAL_ERR;
+	lval* v = lval_alloc(LVAL_ERR);
 
 	/* Create a va list and initialize it */
 	va_list va;
@@ -365,6 +694,7 @@ lval* lval_err(char* fmt, ...) {
 
 	/* Reallocate to number of bytes actually used */
 	v->err = realloc(v->err, strlen(v->err)+1);
+	lalloc_bytes(strlen(v->err) + 1);
 
 	/* Clean up our list */
 	va_end(va);
@@ -374,89 +704,98 @@ lval* lval_err(char* fmt, ...) {
 
 /* Construct a pointer to a new Symbol lval */
 lval* lval_sym(char* s) {
-	lval* v = malloc(sizeof(lval));
-	v->type = LVAL_SYM;
-	v->sym = malloc(strlen(s) +  1);
-	strcpy(v->sym, s);
+	lval* v = lval_alloc(LVAL_SYM);
+	v->sym = lsym_intern(s);
 	return v;
 }
 
 /* Construct a pointer to a new string lval */
 lval* lval_str(char* s) {
-	lval* v = malloc(sizeof(lval));
-	v->type = LVAL_STR;
+	lval* v = lval_alloc(LVAL_STR);
 	v->str = malloc(strlen(s) + 1);
+	lalloc_bytes(strlen(s) + 1);
 	strcpy(v->str, s);
 	return v;
 }
 
 /* Construct a pointer to a new empty Sexpr lval */
 lval* lval_sexpr(void) {
-	lval* v = malloc(sizeof(lval));
-	v->type = LVAL_SEXPR;
+	lval* v = lval_alloc(LVAL_SEXPR);
 	v->count = 0;
 	v->cell = NULL;
+	v->vec = NULL;
 	return v;
 }
 
 /* Construct a pointer to a new empty Qexpr lval */
 lval* lval_qexpr(void) {
-	lval* v = malloc(sizeof(lval));
-	v->type = LVAL_QEXPR;
+	lval* v = lval_alloc(LVAL_QEXPR);
 	v->count = 0;
 	v->cell = NULL;
+	v->vec = NULL;
 	return v;
 }
 
 /* Construct a pointer to a new lval function pointer */
 lval* lval_fun(lbuiltin func) {
-	lval* v = malloc(sizeof(lval));
-	v->type = LVAL_FUN;
+	lval* v = lval_alloc(LVAL_FUN);
 	v->builtin = func;
 	return v;
 }
 
-/* Free/Delete input lval */
+/* Release a reference to input lval, freeing it when none remain */
 void lval_del(lval* v) {
-	
+
+	/* Still referenced elsewhere */
+	if (--v->ref > 0) { return; }
+
 	/* Depending on the type:*/
 	switch(v->type) {
 		/* Do nothing special for number type*/
 		case LVAL_NUM: break;
+		case LVAL_DBL: break;
+		case LVAL_BIGNUM: lbig_free(&v->big); break;
+		case LVAL_PACK: lpack_free(&v->pack); break;
 		
 		/* For Fun type clear formals and environment*/
 		case LVAL_FUN: 
 			if(v->builtin == NULL){
-				lenv_del(v->env);
+				if (v->bound != NULL) { lval_del(v->bound); }
 				lval_del(v->formals);
 				lval_del(v->body);
+				if (v->code != NULL) { lcode_release(v->code); }
 			}
 		break;
 
-		/* For Err, Sym, or Str free the string data*/
-		case LVAL_ERR: free(v->err); break;
-		case LVAL_SYM: free(v->sym); break;
-		case LVAL_STR: free(v->str); break;
+		/* For Err or Str free the string data, Sym is interned */
+		case LVAL_ERR: lalloc_bytes(-(long)strlen(v->err) - 1); free(v->err); break;
+		case LVAL_SYM: break;
+		case LVAL_STR: lalloc_bytes(-(long)strlen(v->str) - 1); free(v->str); break;
 
-		/* If Q-expr or S-expr then delete all elements inside */
+		/* If Q-expr or S-expr release the cell buffer, */
+		/* which deletes the elements once unviewed     */
 		case LVAL_SEXPR:
 		case LVAL_QEXPR:
-			for (int i = 0; i < v->count; i++) {
-				lval_del(v->cell[i]);
-			}
-			/* Also free memory allocated to contain the pointers */
-			free(v->cell);
+			if (v->vec != NULL) { lvec_release(v->vec); }
 		break;
 	}
 	
 	/* Free the memory allocated for the "lval" struct itself */
-	free(v);
+	lalloc_free_lval(v);
 }
 
 
 void lval_print(lval* v) {
 	switch(v->type) {
 		case LVAL_NUM: printf("%li", v->num); break;
+		case LVAL_DBL: lval_print_dbl(v->dbl); break;
+		case LVAL_PACK: lval_print_pack(v); break;
+		case LVAL_BIGNUM: {
+			char* digits = lbig_str(&v->big);
+			fputs(digits, stdout);
+			free(digits);
+		}
+		break;
 		case LVAL_ERR: printf("Error: %s", v->err); break;
 		case LVAL_SYM: printf("%s", v->sym); break;
 		case LVAL_STR: lval_print_str(v); break;	 
@@ -464,8 +803,14 @@ void lval_print(lval* v) {
 			if ( v->builtin != NULL ) {
 				printf("<builtin>");
 			} else {
-				printf("(\\ "); lval_print(v->formals);
+				/* A partial application shows the formals left to give */
+				lval* formals = lval_unshare(lval_copy(v->formals));
+				for (int i = 0; v->bound != NULL && i < v->bound->count; i++) {
+					lval_del(lval_pop(formals, 0));
+				}
+				printf("(\\ "); lval_print(formals);
 				putchar(' '); lval_print(v->body); putchar(')');
+				lval_del(formals);
 			} 
 		break;
 		case LVAL_SEXPR: lval_expr_print(v, '(', ')'); break;
@@ -475,6 +820,37 @@ void lval_print(lval* v) {
 	}
 }
 
+/* Print a Packed Vector as the expression that makes it */
+void lval_print_pack(lval* v) {
+	printf(v->pack.kind == LPACK_DBL ? "(dvec {" : "(ivec {");
+	for (long i = 0; i < v->pack.count; i++) {
+		if (i > 0) { putchar(' '); }
+		if (v->pack.kind == LPACK_DBL) {
+			lval_print_dbl(((double*)v->pack.data)[i]);
+		} else {
+			printf("%lli", (long long)((int64_t*)v->pack.data)[i]);
+		}
+	}
+	printf("})");
+}
+
+/* Print the fewest digits that read back as 'x', always with a '.' or */
+/* an exponent so that it reads back as a Double. Infinities and nans  */
+/* are spelt +inf.0, -inf.0 and +nan.0, which both readers take as     */
+/* Doubles, the sign being required so that inf and nan stay symbols.  */
+void lval_print_dbl(double x) {
+	if (isnan(x)) { fputs("+nan.0", stdout); return; }
+	if (isinf(x)) { fputs(x > 0 ? "+inf.0" : "-inf.0", stdout); return; }
+
+	char buf[32];
+	for (int digits = 15; digits <= 17; digits++) {
+		snprintf(buf, sizeof(buf), "%.*g", digits, x);
+		if (strtod(buf, NULL) == x) { break; }
+	}
+	if (strpbrk(buf, ".e") == NULL) { strcat(buf, ".0"); }
+	fputs(buf, stdout);
+}
+
 /* Print an "lval" followed by a newline */
 void lval_println(lval* v) { lval_print(v); putchar('\n'); }
 
@@ -486,10 +862,21 @@ int lval_eq(lval* x, lval* y) {
 	switch (x->type) {
 
 	case LVAL_NUM: return (x->num == y->num);
+	case LVAL_DBL: return (x->dbl == y->dbl);
+	case LVAL_PACK:
+		if (x->pack.kind != y->pack.kind || x->pack.count != y->pack.count) { return 0; }
+		for (long i = 0; i < x->pack.count; i++) {
+			int same = x->pack.kind == LPACK_DBL
+				? ((double*)x->pack.data)[i] == ((double*)y->pack.data)[i]
+				: ((int64_t*)x->pack.data)[i] == ((int64_t*)y->pack.data)[i];
+			if (!same) { return 0; }
+		}
+		return 1;
+	case LVAL_BIGNUM: return lbig_cmp(&x->big, &y->big) == 0;
 
 	/* Compare String values */
 	case LVAL_ERR: return (strcmp(x->err, y->err) == 0);
-	case LVAL_SYM: return (strcmp(x->sym, y->sym) == 0);
+	case LVAL_SYM: return (x->sym == y->sym);
 	case LVAL_STR: return (strcmp(x->str, y->str) == 0);
 
 	/* If builtin compare, otherwise compare formals and body */
@@ -497,6 +884,9 @@ int lval_eq(lval* x, lval* y) {
 		if(x->builtin || y->builtin) {
 			return x->builtin == y->builtin;
 		} else {
+			/* Partial applications also compare the arguments given */
+			if ((x->bound == NULL) != (y->bound == NULL)) { return 0; }
+			if (x->bound != NULL && !lval_eq(x->bound, y->bound)) { return 0; }
 			return lval_eq(x->formals, y->formals) && lval_eq(x->body, y->body);
 		}
 
@@ -1,38 +1,86 @@
 #ifndef LVALUE_HEADER
 #define LVALUE_HEADER
 
+// Local Include
+#include "lbignum.h"
+#include "lpack.h"
+
 /* Forward declare dependencies */
 typedef struct mpc_ast_t mpc_ast_t;
 
 struct lenv;
 struct lval;
+struct lvec;
+struct lcode;
 typedef struct lenv lenv;
 typedef struct lval lval;
+typedef struct lvec lvec;
+typedef struct lcode lcode;
 typedef lval*(*lbuiltin)(lenv*, lval*);
 
 /*===================================== Struct Definitions =====================================*/
 
+/* Storage behind S/Q-expression cells. A list views the range       */
+/* [cell, cell+count) of a buffer, and several lists may view slices  */
+/* of one buffer, which is what makes 'tail' O(1). The buffer holds a */
+/* reference to every non-NULL item below 'used', and it may only be  */
+/* written to by a list that is its sole viewer (ref == 1).           */
+struct lvec {
+	int ref;
+	int cap;
+	int used;
+	lval* items[];
+};
+
+/* Values are reference counted. Once an lval is shared (ref > 1) it */
+/* must not be mutated; use lval_unshare to get a private copy first. */
+/* The payload is a union selected by 'type', so a value is only as   */
+/* large as its biggest variant rather than the sum of them all.      */
 struct lval
 {
 	int type;
-
-	/* Basic */
-	long num;
-	char* err;
-	char* sym;
-	char* str;
-
-	/* Function */
-	lbuiltin builtin;
-	lenv* env;
-	lval* formals;
-	lval* body;
-	
-	/* Expression */
-	int count;
-	struct lval** cell;
+	int ref;
+
+	union {
+		/* Basic */
+		long num;
+		char* err;
+		char* sym; /* Interned, see lsymbol.h */
+		char* str;
+		lbig big; /* Only ever outside the range of a long */
+		double dbl;
+		lpack pack;
+
+		/* Function, builtin is NULL for lambdas */
+		/* code is the compiled body, see lcompile.h */
+		/* A partial application shares the formals, body and code of */
+		/* the lambda it applies, and holds the arguments given in     */
+		/* 'bound', which is NULL for a lambda that is not partial     */
+		struct {
+			lbuiltin builtin;
+			lval* bound;
+			lval* formals;
+			lval* body;
+			lcode* code;
+		};
+
+		/* Expression, cell points into vec (both NULL when empty) */
+		struct {
+			int count;
+			struct lval** cell;
+			lvec* vec;
+		};
+	};
 };
 
+/* Numbers in this range are preallocated and shared by lval_num */
+#define LVAL_SMALL_MIN -128
+#define LVAL_SMALL_MAX 1023
+
+/* Preallocated values start with this reference count so that balanced */
+/* copies and deletes can never bring them down to zero.                */
+#define LVAL_IMMORTAL (1 << 30)
+
 /*===================================== Declared Functions =====================================*/
 
 /* lval printers */
@@ -40,9 +88,14 @@ void lval_print(lval* v);
 void lval_println(lval* v);
 void lval_expr_print(lval* v, char open, char close);
 void lval_print_str(lval* v);
+void lval_print_dbl(double x);
+void lval_print_pack(lval* v);
 
 /* lval constructors */
 lval* lval_num(long x);
+lval* lval_bignum(lbig* b);
+lval* lval_dbl(double x);
+lval* lval_pack(lpack* p);
 lval* lval_err(char* fmt, ...);
 lval* lval_sym(char* m);
 lval* lval_str(char* s);
@@ -50,15 +103,19 @@ lval* lval_sexpr(void);
 lval* lval_qexpr(void);
 lval* lval_fun(lbuiltin func);
 lval* lval_lambda(lval* formals, lval* body);
+lval* lval_partial(lval* f, lval* a);
 
 /* Function caller */
 lval* lval_call(lenv* e, lval* f, lval* a);
+lval* lval_apply(lenv* e, lval* f, lval* a);
+lval* lval_tail(lenv* e, lval* f, lval* a);
 
 /* lval Destructor */
 void lval_del(lval* v);
 
 /* lval Copier */
 lval* lval_copy(lval* v);
+lval* lval_unshare(lval* v);
 
 /* Lval Readers */
 lval* lval_read(mpc_ast_t* t);
@@ -70,6 +127,7 @@ lval* lval_add(lval* v, lval* x);
 lval* lval_join(lval* x, lval* y);
 lval* lval_eval_sexpr(lenv* e, lval* v);
 lval* lval_eval(lenv* e, lval* v);
+lval* lval_eval_tail(lenv* e, lval* v);
 lval* lval_pop(lval* v, int i);
 lval* lval_take(lval* v, int i);
 
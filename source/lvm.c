@@ -0,0 +1,225 @@
+
+/*========================================= Includes =========================================*/
+
+// Standard Include
+#include <stdlib.h>
+
+// Local Include
+#include "lisputils.h"
+#include "lenviron.h"
+#include "lsymbol.h"
+#include "lcompile.h"
+#include "lvalue.h"
+#include "builtin.h"
+#include "lprof.h"
+
+// Header Include
+#include "lvm.h"
+
+/*===================================== Engine Selection =====================================*/
+
+int lvm_enabled = 1;
+
+void lvm_prepare(lval* f) {
+	if (lvm_enabled && f->code == NULL) { f->code = lcode_compile(f); }
+}
+
+/*====================================== Virtual Machine ======================================*/
+
+/* Copy a looked up value, or report the symbol as unbound */
+static lval* lvm_value(lval* v, char* sym) {
+	return v != NULL ? lval_copy(v) : lval_err("Unbound Symbol '%s'!", sym);
+}
+
+/* Find the function bound to 'sym' through the inline cache 'ic'. The */
+/* cache holds while no global binding is replaced and nothing but the */
+/* global environment binds the symbol. Returns a value not referenced */
+/* by the caller, or NULL if the symbol is unbound.                    */
+static lval* lvm_cached(lenv* e, char* sym, lcache* ic) {
+	if (ic->version == lenv_global_version && lsym_bindings(sym) == 1) {
+		return ic->fun;
+	}
+
+	lval* v = lenv_lookup(e, sym);
+	if (v != NULL && v->type == LVAL_FUN && lsym_bindings(sym) == 1
+		&& lenv_global() != NULL && lenv_slot(lenv_global(), sym) >= 0) {
+		ic->version = lenv_global_version;
+		ic->fun = v;
+	}
+	return v;
+}
+
+/* Collect the 'n' values in 'top' into an argument list, consuming */
+/* them. The first error wins, as in lval_eval_sexpr.               */
+static lval* lvm_args(lval** top, int n) {
+	for (int i = 0; i < n; i++) {
+		if (top[i]->type == LVAL_ERR) {
+			lval* err = top[i];
+			for (int j = 0; j < n; j++) {
+				if (j != i) { lval_del(top[j]); }
+			}
+			return err;
+		}
+	}
+
+	lval* a = lval_sexpr();
+	for (int i = 0; i < n; i++) { a = lval_add(a, top[i]); }
+	return a;
+}
+
+/* Call the 'n' values in 'top', consuming them, as (f a...) would be. */
+/* A call in tail position may be left to lval_apply, see lval_tail.  */
+static lval* lvm_call(lenv* e, lval** top, int n, int tail) {
+	lval* f = top[0];
+	if (f->type == LVAL_ERR) {
+		for (int i = 1; i < n; i++) { lval_del(top[i]); }
+		return f;
+	}
+
+	lval* a = lvm_args(top + 1, n - 1);
+	if (a->type == LVAL_ERR) {
+		lval_del(f);
+		return a;
+	}
+
+	return tail ? lval_tail(e, f, a) : lval_apply(e, f, a);
+}
+
+/* Call the function bound to 'sym' with the 'n' values in 'top' */
+static lval* lvm_call_global(lenv* e, char* sym, lcache* ic, lval** top, int n, int tail) {
+	lval* f = lvm_cached(e, sym, ic);
+	if (f == NULL) {
+		for (int i = 0; i < n; i++) { lval_del(top[i]); }
+		return lval_err("Unbound Symbol '%s'!", sym);
+	}
+
+	lval* a = lvm_args(top, n);
+	if (a->type == LVAL_ERR) { return a; }
+
+	/* Builtins are called directly, they do not need 'f' to stay alive. */
+	/* Anything else is referenced in case the call redefines it.        */
+	if (f->type == LVAL_FUN && f->builtin != NULL
+		&& f->builtin != builtin_if && f->builtin != builtin_eval) {
+		if (!lprof_enabled) { return f->builtin(e, a); }
+		lprof_enter(f);
+		lval* r = f->builtin(e, a);
+		lprof_exit();
+		return r;
+	}
+	return tail ? lval_tail(e, lval_copy(f), a) : lval_apply(e, lval_copy(f), a);
+}
+
+lval* lvm_exec(lcode* c, lenv* e) {
+	lval* stack[c->max_stack];
+	int sp = 0;
+
+	/* Code outlives this call even if the lambda running it is redefined */
+	c->ref++;
+
+	int* ops = c->ops;
+	int pc = 0;
+	for (;;) {
+		switch (ops[pc]) {
+			case LOP_CONST:
+				stack[sp++] = lval_copy(c->consts[ops[pc + 1]]);
+				pc += 2;
+			break;
+
+			case LOP_LOCAL: {
+				/* The slot holds another symbol if the frame has grown */
+				char* sym = c->consts[ops[pc + 1]]->sym;
+				int s = ops[pc + 2];
+				lval* v = s < e->cap && e->syms[s] == sym ? e->vals[s] : lenv_lookup(e, sym);
+				stack[sp++] = lvm_value(v, sym);
+				pc += 3;
+			} break;
+
+			case LOP_GLOBAL: {
+				/* The global slot is only used while nothing else binds */
+				/* the symbol. Otherwise look it up and re-resolve.      */
+				char* sym = c->consts[ops[pc + 1]]->sym;
+				int s = ops[pc + 2];
+				lenv* g = lenv_global();
+				lval* v;
+				if (s >= 0 && lsym_bindings(sym) == 1 && s < g->cap && g->syms[s] == sym) {
+					v = g->vals[s];
+				} else {
+					v = lenv_lookup(e, sym);
+					if (v != NULL && g != NULL && lsym_bindings(sym) == 1) {
+						ops[pc + 2] = lenv_slot(g, sym);
+					}
+				}
+				stack[sp++] = lvm_value(v, sym);
+				pc += 3;
+			} break;
+
+			case LOP_CALL: {
+				int n = ops[pc + 1];
+				sp -= n;
+				stack[sp] = lvm_call(e, stack + sp, n, 0);
+				sp++;
+				pc += 2;
+			} break;
+
+			case LOP_TAILCALL: {
+				/* Nothing follows but a return, so hand the call back */
+				int n = ops[pc + 1];
+				sp -= n;
+				stack[sp] = lvm_call(e, stack + sp, n, 1);
+				sp++;
+				pc += 2;
+			} break;
+
+			case LOP_GFUN: {
+				char* sym = c->consts[ops[pc + 1]]->sym;
+				stack[sp++] = lvm_value(lvm_cached(e, sym, c->caches + ops[pc + 2]), sym);
+				pc += 3;
+			} break;
+
+			case LOP_CALLG:
+			case LOP_TAILCALLG: {
+				int n = ops[pc + 3];
+				sp -= n;
+				stack[sp] = lvm_call_global(e, c->consts[ops[pc + 1]]->sym,
+					c->caches + ops[pc + 2], stack + sp, n, ops[pc] == LOP_TAILCALLG);
+				sp++;
+				pc += 4;
+			} break;
+
+			case LOP_IFGUARD: {
+				lval* f = lvm_cached(e, c->consts[ops[pc + 1]]->sym, c->caches + ops[pc + 2]);
+				if (f != NULL && f->type == LVAL_FUN && f->builtin == builtin_if) {
+					pc += 4;
+				} else {
+					pc = ops[pc + 3];
+				}
+			} break;
+
+			case LOP_TEST: {
+				lval* x = stack[--sp];
+				if (x->type == LVAL_ERR) {
+					stack[sp++] = x;
+					pc = ops[pc + 2];
+				} else if (x->type != LVAL_NUM) {
+					stack[sp++] = lval_err(
+						"Function 'if' passed incorrect type for argument 0. "
+						"Got %s, Expected %s.",
+						ltype_name(x->type), ltype_name(LVAL_NUM));
+					lval_del(x);
+					pc = ops[pc + 2];
+				} else {
+					pc = x->num ? pc + 3 : ops[pc + 1];
+					lval_del(x);
+				}
+			} break;
+
+			case LOP_JUMP:
+				pc = ops[pc + 1];
+			break;
+
+			case LOP_RETURN:
+				lcode_release(c);
+				return stack[--sp];
+		}
+	}
+}
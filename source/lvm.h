@@ -0,0 +1,26 @@
+#ifndef LVM_HEADER
+#define LVM_HEADER
+
+/* Forward declare dependencies */
+struct lval;
+struct lenv;
+struct lcode;
+typedef struct lval lval;
+typedef struct lenv lenv;
+typedef struct lcode lcode;
+
+/*===================================== Engine Selection =====================================*/
+
+/* Lambda bodies run on the VM when set, otherwise on the tree walker. */
+/* Set by --engine=vm|tree, on by default.                            */
+extern int lvm_enabled;
+
+/*===================================== Declared Functions =====================================*/
+
+/* Compile a lambda's body if the VM is enabled and it is not compiled yet */
+void lvm_prepare(lval* f);
+
+/* Run compiled code in environment 'e', returning the resulting value */
+lval* lvm_exec(lcode* c, lenv* e);
+
+#endif
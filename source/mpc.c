@@ -80,6 +80,7 @@ typedef struct {
   mpc_state_t state;
   
   char *string;
+  size_t length;
   char *buffer;
   FILE *file;
   
@@ -108,7 +109,8 @@ static mpc_input_t *mpc_input_new_string(const char *filename, const char *strin
   
   i->state = mpc_state_new();
   
-  i->string = malloc(strlen(string) + 1);
+  i->length = strlen(string);
+  i->string = malloc(i->length + 1);
   strcpy(i->string, string);
   i->buffer = NULL;
   i->file = NULL;
@@ -140,6 +142,7 @@ static mpc_input_t *mpc_input_new_nstring(const char *filename, const char *stri
   i->string = malloc(length + 1);
   strncpy(i->string, string, length);
   i->string[length] = '\0';
+  i->length = strlen(i->string);
   i->buffer = NULL;
   i->file = NULL;
   
@@ -169,6 +172,7 @@ static mpc_input_t *mpc_input_new_pipe(const char *filename, FILE *pipe) {
   i->state = mpc_state_new();
   
   i->string = NULL;
+  i->length = 0;
   i->buffer = NULL;
   i->file = pipe;
   
@@ -197,6 +201,7 @@ static mpc_input_t *mpc_input_new_file(const char *filename, FILE *file) {
   i->state = mpc_state_new();
   
   i->string = NULL;
+  i->length = 0;
   i->buffer = NULL;
   i->file = file;
   
@@ -362,7 +367,7 @@ static char mpc_input_buffer_get(mpc_input_t *i) {
 }
 
 static int mpc_input_terminated(mpc_input_t *i) {
-  if (i->type == MPC_INPUT_STRING && i->state.pos == (long)strlen(i->string)) { return 1; }
+  if (i->type == MPC_INPUT_STRING && i->state.pos == (long)i->length) { return 1; }
   if (i->type == MPC_INPUT_FILE && feof(i->file)) { return 1; }
   if (i->type == MPC_INPUT_PIPE && feof(i->file)) { return 1; }
   return 0;
@@ -1,13 +1,20 @@
 // Standard Library Includes
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 // Internal Includes
 #include "mpc.h"
 #include "lisputils.h"
 #include "lvalue.h"
+#include "lsymbol.h"
+#include "lalloc.h"
 #include "lenviron.h"
 #include "builtin.h"
+#include "lvm.h"
+#include "lprof.h"
+#include "lread.h"
+#include "limage.h"
 
 // Header Include
 #include "parse.h"
@@ -38,53 +45,125 @@ void add_history(char * unused) {}
 
 int parse(int argc, char* argv[]) {
 
-	/* Create Some Parsers*/
-	Number   = mpc_new("number");
-	Symbol   = mpc_new("symbol");
-	String   = mpc_new("string");
-	Comment  = mpc_new("comment");
-	Sexpr	 = mpc_new("sexpr");
-	Qexpr    = mpc_new("qexpr");
-	Expr 	 = mpc_new("expr");
-	Lispy	 = mpc_new("lispy");
-
-	/* Define them with the following Language */
-	mpca_lang(MPCA_LANG_DEFAULT, 
-		"														 \
-			number 	 : /-?[0-9]+/ ;								 \
-			symbol   : /[a-zA-Z0-9_+\\-*\\/\\\\=<>!&\\^\\%]+/ ;  \
-			string   : /\"(\\\\.|[^\"])*\"/ ;                    \
-			comment  : /;[^\\r\\n]*/ ;							 \
-			sexpr    : '(' <expr>* ')' ;                         \
-			qexpr	 : '{' <expr>* '}' ;                         \
-			expr  	 : <number>  | <symbol> | <string>           \
-					 | <comment> | <sexpr>  | <qexpr>;           \
-			lispy 	 : /^/ <expr>* /$/ ;						 \
-		",
-		 Number, Symbol, String, Comment, Sexpr, Qexpr, Expr, Lispy);  
+	/* Handle command line options */
+	int files = parse_options(argc, argv);
+	if (files < 0) { return 1; }
+
+	/* The mpc grammar is only built when --reader=mpc asks for it */
+	if (!lread_enabled) {
+		/* Create Some Parsers*/
+		Number   = mpc_new("number");
+		Symbol   = mpc_new("symbol");
+		String   = mpc_new("string");
+		Comment  = mpc_new("comment");
+		Sexpr	 = mpc_new("sexpr");
+		Qexpr    = mpc_new("qexpr");
+		Expr 	 = mpc_new("expr");
+		Lispy	 = mpc_new("lispy");
+
+		/* Define them with the following Language */
+		mpca_lang(MPCA_LANG_DEFAULT, 
+			"														 \
+				number 	 : /-?[0-9]+(\\.[0-9]+)?([eE][-+]?[0-9]+)?|[-+](inf|nan)\\.0/ ; \
+				symbol   : /[a-zA-Z0-9_+\\-*\\/\\\\=<>!&\\^\\%]+/ ;  \
+				string   : /\"(\\\\.|[^\"])*\"/ ;                    \
+				comment  : /;[^\\r\\n]*/ ;							 \
+				sexpr    : '(' <expr>* ')' ;                         \
+				qexpr	 : '{' <expr>* '}' ;                         \
+				expr  	 : <number>  | <symbol> | <string>           \
+						 | <comment> | <sexpr>  | <qexpr>;           \
+				lispy 	 : /^/ <expr>* /$/ ;						 \
+			",
+			 Number, Symbol, String, Comment, Sexpr, Qexpr, Expr, Lispy);  
+	}
 
 	/* Initialize environment */
 	lenv* e = lenv_new();
 	lenv_add_builtins(e);
 
-	/* Interactive Prompt */
-	if ( argc == 1 ) {
+	/* Start from the bindings in the image given by --image */
+	int status = 0;
+	if (limage_in != NULL) {
+		lval* x = limage_load(e, limage_in);
+		if (x->type == LVAL_ERR) { lval_println(x); status = 1; }
+		lval_del(x);
+	}
+
+	/* Interactive Prompt, unless writing an image */
+	if ( status == 0 && files == 0 && limage_out == NULL ) {
 		REPL_loop(e);
 	}
 
 	/* Supplied with list of files */
-	if (argc >= 2) {
+	if (status == 0 && files >= 1) {
 		REPL_args(e, argc, argv);			
 	}
 
+	/* Write what the files defined with --dump-image */
+	if (status == 0 && limage_out != NULL) {
+		lval* x = limage_dump(e, limage_out);
+		if (x->type == LVAL_ERR) { lval_println(x); status = 1; }
+		lval_del(x);
+	}
+
+	/* Report where the time went with --profile */
+	if (lprof_enabled) { lprof_report(); }
+
 	lenv_del(e);
 
+	/* Everything is freed by now, so anything alive has leaked */
+	if (lalloc_print) { lalloc_print_stats(); }
+
+	lsym_cleanup();
+	lalloc_cleanup();
+
 	/* Undefine and Delete our Parsers */
-	mpc_cleanup(8, 
-		Number, Symbol, String, Comment, 
-		Sexpr,  Qexpr,  Expr,   Lispy);
+	if (!lread_enabled) {
+		mpc_cleanup(8,
+			Number, Symbol, String, Comment,
+			Sexpr,  Qexpr,  Expr,   Lispy);
+	}
 
-	return 0;
+	return status;
+}
+
+/* Apply options beginning with '--', returning the number of files */
+/* given, or -1 if an option is not recognised                      */
+int parse_options(int argc, char* argv[]) {
+	int files = 0;
+
+	for (int i = 1; i < argc; i++) {
+		if (strncmp(argv[i], "--", 2) != 0) { files++; continue; }
+
+		/* --engine=vm|tree selects how lambda bodies are run */
+		if (strcmp(argv[i], "--engine=vm") == 0)   { lvm_enabled = 1; continue; }
+		if (strcmp(argv[i], "--engine=tree") == 0) { lvm_enabled = 0; continue; }
+
+		/* --reader=fast|mpc selects how source is read */
+		if (strcmp(argv[i], "--reader=fast") == 0) { lread_enabled = 1; continue; }
+		if (strcmp(argv[i], "--reader=mpc") == 0)  { lread_enabled = 0; continue; }
+
+		/* --memstats prints allocation counters and leaks on exit */
+		if (strcmp(argv[i], "--memstats") == 0) { lalloc_print = 1; continue; }
+
+		/* --profile[=FILE] reports calls on exit, writing stacks to FILE */
+		if (strcmp(argv[i], "--profile") == 0) { lprof_enabled = 1; continue; }
+		if (strncmp(argv[i], "--profile=", 10) == 0) {
+			lprof_enabled = 1;
+			lprof_stacks = argv[i] + 10;
+			continue;
+		}
+
+		/* --dump-image=FILE writes the global environment to FILE once */
+		/* the files are loaded, --image=FILE starts from such a FILE  */
+		if (strncmp(argv[i], "--dump-image=", 13) == 0) { limage_out = argv[i] + 13; continue; }
+		if (strncmp(argv[i], "--image=", 8) == 0)       { limage_in = argv[i] + 8; continue; }
+
+		fprintf(stderr, "Unknown option '%s'\n", argv[i]);
+		return -1;
+	}
+
+	return files;
 }
 
 void REPL_loop(lenv* e) {
@@ -99,21 +178,37 @@ void REPL_loop(lenv* e) {
 		add_history(input);
 
 		/* Attempt to parse the user input */
-		mpc_result_t r;
-		if(mpc_parse("<stdin>", input, Lispy, &r)) {
-
-		/* On success print result and delete the AST */
-		lval*  x = lval_eval(e, lval_read(r.output));
-		lval_println(x);
-		lval_del(x);
-		mpc_ast_delete(r.output);
-		} 
+		if (lread_enabled) {
+
+			/* The expressions read, or the error, are printed as by mpc */
+			lval* x = lread("<stdin>", input, strlen(input));
+			if (x->type == LVAL_ERR) {
+				fputs(x->err, stdout);
+				lval_del(x);
+			} else {
+				x = lval_eval(e, x);
+				lval_println(x);
+				lval_del(x);
+			}
+		}
 
 		else {
-
-			/* Otherwise print and delete the Error */
-			mpc_err_print(r.error);
-			mpc_err_delete(r.error);
+			mpc_result_t r;
+			if(mpc_parse("<stdin>", input, Lispy, &r)) {
+
+			/* On success print result and delete the AST */
+			lval*  x = lval_eval(e, lval_read(r.output));
+			lval_println(x);
+			lval_del(x);
+			mpc_ast_delete(r.output);
+			} 
+
+			else {
+
+				/* Otherwise print and delete the Error */
+				mpc_err_print(r.error);
+				mpc_err_delete(r.error);
+			}
 		}
 
 		/*Free retrieved input*/
@@ -127,6 +222,9 @@ void REPL_args(lenv* e, int argc, char* argv[]){
 	/* loop over each supplied filename (starting from 1) */
 	for (int i = 1; i < argc; i++) {
 
+		/* Options were handled by parse_options */
+		if (strncmp(argv[i], "--", 2) == 0) { continue; }
+
 		/* Argument list with a single argument, the filename */
 		lval* args = lval_add(lval_sexpr(), lval_str(argv[i]));
 
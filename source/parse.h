@@ -22,6 +22,7 @@ mpc_parser_t* Lispy;
 /*============================= Declared Functions =============================*/
 
 int parse(int argc, char* argv[]);
+int parse_options(int argc, char* argv[]);
 
 void REPL_loop(lenv* e);
 void REPL_args(lenv* e, int argc, char* argv[]);